@@ -0,0 +1,251 @@
+/**
+ * @file HttpBenchmarks.cpp
+ *
+ * This module contains microbenchmarks of the hot paths of the
+ * Http::Server and Http::Client classes: request parsing at various
+ * header counts, body extraction, route lookup at various depths, and
+ * response serialization.  Run these before and after any change to the
+ * parse or serialize paths to catch throughput regressions.
+ */
+
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Http/Server.hpp>
+#include <Http/Client.hpp>
+#include <Http/ServerTransportLayer.hpp>
+#include <Http/Connection.hpp>
+#include <StringUtils/StringUtils.hpp>
+
+namespace {
+
+    /**
+     * This is a fake client connection which is used to drive the
+     * server's full receive path in benchmarks.
+     */
+    struct BenchmarkConnection : public Http::Connection
+    {
+        // Properties
+
+        /**
+         * This is the delegate to call whenever data is received from
+         * the remote peer.
+         */
+        DataReceivedDelegate dataReceivedDelegate;
+
+        /**
+         * This is the delegate to call whenever connection has been broken.
+         */
+        BrokenDelegate brokenDelegate;
+
+        /**
+         * This counts the bytes the server has sent back, so that the
+         * responses don't accumulate in memory across iterations.
+         */
+        size_t bytesSent = 0;
+
+        // Http::Connection
+
+        virtual std::string GetPeerId() override {
+            return "benchmark-client";
+        }
+
+        virtual void SetDataReceivedDelegate(DataReceivedDelegate newDataReceivedDelegate) override {
+            dataReceivedDelegate = newDataReceivedDelegate;
+        }
+
+        virtual void SetConnectionBrokenDelegate(BrokenDelegate newBrokenDelegate) override {
+            brokenDelegate = newBrokenDelegate;
+        }
+
+        virtual void SendData(const std::vector< uint8_t >& data) override {
+            bytesSent += data.size();
+        }
+
+        virtual void Break(bool clean) override {
+        }
+    };
+
+    /**
+     * This is a fake transport layer which is used to mobilize the
+     * server in benchmarks.
+     */
+    struct BenchmarkTransport : public Http::ServerTransportLayer {
+        // Properties
+
+        /**
+         * This is the delegate to call whenever a new connection has
+         * been established for the server.
+         */
+        NewConnectionDelegate connectionDelegate;
+
+        // Http::ServerTransportLayer
+
+        virtual bool BindNetwork(
+            uint16_t newPort,
+            NewConnectionDelegate newConnectionDelegate
+        ) override {
+            connectionDelegate = newConnectionDelegate;
+            return true;
+        }
+
+        virtual uint16_t GetBoundPort() override {
+            return 1234;
+        }
+
+        virtual void ReleaseNetwork() override {
+        }
+    };
+
+    /**
+     * This builds a raw GET request with the given number of filler
+     * headers, representative of requests captured from browsers and
+     * API clients.
+     *
+     * @param[in] numHeaders
+     *      This is the number of filler headers to include.
+     *
+     * @return
+     *      The raw request is returned.
+     */
+    std::string MakeRawRequest(size_t numHeaders) {
+        std::string rawRequest = (
+            "GET /foo/bar HTTP/1.1\r\n"
+            "Host: www.example.com\r\n"
+        );
+        for (size_t i = 0; i < numHeaders; ++i) {
+            rawRequest += StringUtils::sprintf(
+                "X-Filler-Header-%zu: Some filler value number %zu\r\n",
+                i,
+                i
+            );
+        }
+        rawRequest += "\r\n";
+        return rawRequest;
+    }
+
+    /**
+     * This benchmark measures parsing a request line plus a minimal
+     * header section.
+     */
+    void BM_ParseRequestLine(benchmark::State& state) {
+        Http::Server server;
+        const std::string rawRequest(
+            "GET /hello.txt HTTP/1.1\r\n"
+            "Host: www.example.com\r\n"
+            "\r\n"
+        );
+        for (auto _: state) {
+            benchmark::DoNotOptimize(server.ParseRequest(rawRequest));
+        }
+        state.SetBytesProcessed(state.iterations() * rawRequest.length());
+    }
+    BENCHMARK(BM_ParseRequestLine);
+
+    /**
+     * This benchmark measures parsing a request whose header section
+     * contains the number of headers given by the benchmark argument.
+     */
+    void BM_ParseRequestHeaders(benchmark::State& state) {
+        Http::Server server;
+        const auto rawRequest = MakeRawRequest((size_t)state.range(0));
+        for (auto _: state) {
+            benchmark::DoNotOptimize(server.ParseRequest(rawRequest));
+        }
+        state.SetBytesProcessed(state.iterations() * rawRequest.length());
+    }
+    BENCHMARK(BM_ParseRequestHeaders)->Arg(4)->Arg(16)->Arg(64);
+
+    /**
+     * This benchmark measures extracting a request body whose size is
+     * given by the benchmark argument.
+     */
+    void BM_ParseRequestBody(benchmark::State& state) {
+        Http::Server server;
+        const std::string body((size_t)state.range(0), 'x');
+        const auto rawRequest = (
+            "POST /foo/bar HTTP/1.1\r\n"
+            "Host: www.example.com\r\n"
+            "Content-Type: application/octet-stream\r\n"
+            + StringUtils::sprintf("Content-Length: %zu\r\n", body.length())
+            + "\r\n"
+            + body
+        );
+        for (auto _: state) {
+            benchmark::DoNotOptimize(server.ParseRequest(rawRequest));
+        }
+        state.SetBytesProcessed(state.iterations() * rawRequest.length());
+    }
+    BENCHMARK(BM_ParseRequestBody)->Arg(512)->Arg(16384)->Arg(262144);
+
+    /**
+     * This benchmark measures the server's full receive path — parse,
+     * route lookup, handler dispatch, and response serialization — with
+     * the resource registered at the path depth given by the benchmark
+     * argument.
+     */
+    void BM_RouteLookup(benchmark::State& state) {
+        Http::Server server;
+        const auto transport = std::make_shared< BenchmarkTransport >();
+        (void)server.Mobilize({transport, 1234, nullptr});
+        std::vector< std::string > resourceSubspacePath;
+        std::string targetPath;
+        for (int i = 0; i < state.range(0); ++i) {
+            resourceSubspacePath.push_back(StringUtils::sprintf("segment%d", i));
+            targetPath += "/" + resourceSubspacePath.back();
+        }
+        const auto unregister = server.RegisterResource(
+            resourceSubspacePath,
+            [](std::shared_ptr< Http::Server::Request > request){
+                const auto response = std::make_shared< Http::Client::Response >();
+                response->statusCode = 200;
+                response->status = "OK";
+                response->body = "Hello!";
+                return response;
+            }
+        );
+        const auto connection = std::make_shared< BenchmarkConnection >();
+        transport->connectionDelegate(connection);
+        const auto rawRequest = (
+            "GET " + targetPath + " HTTP/1.1\r\n"
+            "Host: www.example.com\r\n"
+            "\r\n"
+        );
+        for (auto _: state) {
+            // The delegate takes ownership of the buffer, so each
+            // iteration hands over a fresh copy of the raw request.
+            connection->dataReceivedDelegate(
+                std::vector< uint8_t >(rawRequest.begin(), rawRequest.end())
+            );
+        }
+        state.SetBytesProcessed(state.iterations() * rawRequest.length());
+        unregister();
+    }
+    BENCHMARK(BM_RouteLookup)->Arg(1)->Arg(4)->Arg(8);
+
+    /**
+     * This benchmark measures serializing a response whose body size is
+     * given by the benchmark argument.
+     */
+    void BM_GenerateResponseToString(benchmark::State& state) {
+        Http::Client::Response response;
+        response.statusCode = 200;
+        response.status = "OK";
+        response.headers.AddHeader("Content-Type", "text/plain");
+        response.body.assign((size_t)state.range(0), 'x');
+        response.headers.AddHeader(
+            "Content-Length",
+            StringUtils::sprintf("%zu", response.body.length())
+        );
+        size_t responseLength = 0;
+        for (auto _: state) {
+            const auto rawResponse = response.GenerateToString();
+            responseLength = rawResponse.length();
+            benchmark::DoNotOptimize(rawResponse);
+        }
+        state.SetBytesProcessed(state.iterations() * responseLength);
+    }
+    BENCHMARK(BM_GenerateResponseToString)->Arg(512)->Arg(16384)->Arg(262144);
+
+}
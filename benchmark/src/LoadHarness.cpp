@@ -0,0 +1,575 @@
+/**
+ * @file LoadHarness.cpp
+ *
+ * This is a load harness which measures the whole-pipeline performance
+ * of Http::Server, without sockets, by mobilizing a server against an
+ * in-process loopback transport layer and driving it with raw requests
+ * from several generator threads.  It reports requests per second,
+ * service latency percentiles, allocations per request, and the
+ * server's own statistics snapshot.  Run it before and after any
+ * concurrency change to validate the change end to end.
+ *
+ * Usage:
+ *
+ *   HttpLoadHarness [--threads N] [--connections N] [--pipeline N]
+ *                   [--requests N] [--body-size N] [--routes N]
+ *                   [--churn N] [--workers N]
+ *
+ *   --threads N      number of generator threads (default 1)
+ *   --connections N  connections per generator thread (default 10)
+ *   --pipeline N     requests sent back to back per batch (default 1)
+ *   --requests N     total requests to send (default 100000)
+ *   --body-size N    request body size in bytes; 0 means GET (default 0)
+ *   --routes N       number of registered routes to fan out over (default 1)
+ *   --churn N        break and replace a connection after this many
+ *                    requests; 0 disables churn (default 0)
+ *   --workers N      server worker threads (default 0: inline dispatch)
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+#include <Http/Server.hpp>
+#include <Http/Client.hpp>
+#include <Http/Connection.hpp>
+#include <Http/ServerTransportLayer.hpp>
+#include <Http/TimeKeeper.hpp>
+#include <StringUtils/StringUtils.hpp>
+
+namespace {
+
+    /**
+     * This counts every allocation made through the global operator
+     * new, so that the harness can report allocations per request.
+     */
+    std::atomic< size_t > allocationCount{0};
+
+}
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const auto allocation = malloc(size);
+    if (allocation == nullptr) {
+        throw std::bad_alloc();
+    }
+    return allocation;
+}
+
+void* operator new[](std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    const auto allocation = malloc(size);
+    if (allocation == nullptr) {
+        throw std::bad_alloc();
+    }
+    return allocation;
+}
+
+void operator delete(void* allocation) noexcept {
+    free(allocation);
+}
+
+void operator delete(void* allocation, std::size_t) noexcept {
+    free(allocation);
+}
+
+void operator delete[](void* allocation) noexcept {
+    free(allocation);
+}
+
+void operator delete[](void* allocation, std::size_t) noexcept {
+    free(allocation);
+}
+
+namespace {
+
+    /**
+     * This holds the knobs of one harness run, as parsed from the
+     * command line.
+     */
+    struct HarnessConfiguration {
+
+        /**
+         * This is the number of generator threads to run.
+         */
+        size_t threads = 1;
+
+        /**
+         * This is the number of connections each generator thread
+         * keeps open.
+         */
+        size_t connections = 10;
+
+        /**
+         * This is the number of requests sent back to back in one
+         * batch, to exercise pipelining.
+         */
+        size_t pipeline = 1;
+
+        /**
+         * This is the total number of requests to send, across all
+         * generator threads.
+         */
+        size_t requests = 100000;
+
+        /**
+         * This is the size of the request body, in bytes.  Zero means
+         * the requests are GETs with no body.
+         */
+        size_t bodySize = 0;
+
+        /**
+         * This is the number of routes registered with the server, over
+         * which the generated requests fan out round-robin.
+         */
+        size_t routes = 1;
+
+        /**
+         * This is the number of requests after which a connection is
+         * broken and replaced, to exercise connection churn.  Zero
+         * disables churn.
+         */
+        size_t churn = 0;
+
+        /**
+         * This is the number of worker threads the server dispatches
+         * resource delegates on.  Zero means requests are handled
+         * inline on the generator threads.
+         */
+        size_t workers = 0;
+    };
+
+    /**
+     * This is a time keeper backed by the monotonic clock, given to the
+     * server so that its timer wheel and latency histogram run as they
+     * would in production.
+     */
+    struct SteadyClockTimeKeeper : public Http::TimeKeeper {
+        virtual double GetCurrentTime() override {
+            return std::chrono::duration< double >(
+                std::chrono::steady_clock::now().time_since_epoch()
+            ).count();
+        }
+    };
+
+    /**
+     * This is an in-process loopback connection: the generator thread
+     * feeds raw requests into the server through the server's data
+     * received delegate, and everything the server sends back is parsed
+     * as responses right here, with the latency of each request
+     * recorded when its response completes.
+     */
+    struct LoopbackConnection : public Http::Connection {
+        // Properties
+
+        /**
+         * This is the delegate the server gave us to call with
+         * received data.
+         */
+        DataReceivedDelegate dataReceivedDelegate;
+
+        /**
+         * This is the delegate the server gave us to call when the
+         * connection is broken.
+         */
+        BrokenDelegate brokenDelegate;
+
+        /**
+         * This is used to synchronize access to the response side of
+         * the connection, since the server may send from a worker
+         * thread while the generator thread is feeding more requests.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is used to incrementally parse what the server sends
+         * back into responses.
+         */
+        Http::Client responseParser;
+
+        /**
+         * This accumulates the raw bytes the server has sent back
+         * which haven't been fully parsed into responses yet.
+         */
+        std::string receiveBuffer;
+
+        /**
+         * This is the offset into the receive buffer of the first
+         * byte not yet consumed by the response parser.
+         */
+        size_t parseOffset = 0;
+
+        /**
+         * This is the response currently being parsed, if any.
+         */
+        std::shared_ptr< Http::Client::Response > nextResponse;
+
+        /**
+         * These are the times at which the outstanding requests were
+         * sent, oldest first, matched to responses in order.
+         */
+        std::deque< std::chrono::steady_clock::time_point > sendTimes;
+
+        /**
+         * This is where the latency of each completed request is
+         * recorded, in microseconds.
+         */
+        std::vector< double >* latencies = nullptr;
+
+        /**
+         * This counts the responses completed on this connection.
+         */
+        size_t responsesCompleted = 0;
+
+        // Http::Connection
+
+        virtual std::string GetPeerId() override {
+            return "loopback";
+        }
+
+        virtual void SetDataReceivedDelegate(DataReceivedDelegate newDataReceivedDelegate) override {
+            dataReceivedDelegate = newDataReceivedDelegate;
+        }
+
+        virtual void SetConnectionBrokenDelegate(BrokenDelegate newBrokenDelegate) override {
+            brokenDelegate = newBrokenDelegate;
+        }
+
+        virtual void SendData(const std::vector< uint8_t >& data) override {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            receiveBuffer.append(data.begin(), data.end());
+            for (;;) {
+                if (nextResponse == nullptr) {
+                    nextResponse = std::make_shared< Http::Client::Response >();
+                }
+                parseOffset = responseParser.ParseResponse(
+                    nextResponse,
+                    receiveBuffer,
+                    parseOffset
+                );
+                if (!nextResponse->IsProcessed()) {
+                    break;
+                }
+                nextResponse = nullptr;
+                ++responsesCompleted;
+                if (!sendTimes.empty()) {
+                    latencies->push_back(
+                        std::chrono::duration< double, std::micro >(
+                            std::chrono::steady_clock::now() - sendTimes.front()
+                        ).count()
+                    );
+                    sendTimes.pop_front();
+                }
+            }
+            if (parseOffset == receiveBuffer.length()) {
+                receiveBuffer.clear();
+                parseOffset = 0;
+            }
+        }
+
+        virtual void Break(bool clean) override {
+        }
+    };
+
+    /**
+     * This is an in-process loopback transport layer: it just hands
+     * the server's new-connection delegate to the generator threads,
+     * which call it directly to establish connections.
+     */
+    struct LoopbackTransport : public Http::ServerTransportLayer {
+        // Properties
+
+        /**
+         * This is the delegate to call whenever a new connection has
+         * been established for the server.
+         */
+        NewConnectionDelegate connectionDelegate;
+
+        // Http::ServerTransportLayer
+
+        virtual bool BindNetwork(
+            uint16_t newPort,
+            NewConnectionDelegate newConnectionDelegate
+        ) override {
+            connectionDelegate = newConnectionDelegate;
+            return true;
+        }
+
+        virtual uint16_t GetBoundPort() override {
+            return 1234;
+        }
+
+        virtual void ReleaseNetwork() override {
+        }
+    };
+
+    /**
+     * This builds the raw request sent for the route with the given
+     * index, a GET when the configured body size is zero and a POST
+     * carrying a filler body otherwise.
+     *
+     * @param[in] route
+     *      This is the index of the route the request should target.
+     *
+     * @param[in] configuration
+     *      This is the configuration of the harness run.
+     *
+     * @return
+     *      The raw request is returned.
+     */
+    std::string MakeRawRequest(
+        size_t route,
+        const HarnessConfiguration& configuration
+    ) {
+        if (configuration.bodySize == 0) {
+            return StringUtils::sprintf(
+                "GET /r%zu HTTP/1.1\r\n"
+                "Host: loadharness\r\n"
+                "\r\n",
+                route
+            );
+        }
+        return StringUtils::sprintf(
+            "POST /r%zu HTTP/1.1\r\n"
+            "Host: loadharness\r\n"
+            "Content-Length: %zu\r\n"
+            "\r\n",
+            route,
+            configuration.bodySize
+        ) + std::string(configuration.bodySize, 'x');
+    }
+
+    /**
+     * This is the body of one generator thread.  It keeps the
+     * configured number of connections open, feeds batches of raw
+     * requests into the server through them, and replaces connections
+     * as configured to exercise churn.
+     *
+     * @param[in] configuration
+     *      This is the configuration of the harness run.
+     *
+     * @param[in] transport
+     *      This is the loopback transport through which to establish
+     *      connections.
+     *
+     * @param[in] requestsToSend
+     *      This is the number of requests this thread should send.
+     *
+     * @param[out] latencies
+     *      This is where to record the latency of each completed
+     *      request, in microseconds.
+     */
+    void GeneratorThread(
+        const HarnessConfiguration& configuration,
+        LoopbackTransport& transport,
+        size_t requestsToSend,
+        std::vector< double >& latencies
+    ) {
+        std::vector< std::string > rawRequests;
+        rawRequests.reserve(configuration.routes);
+        for (size_t route = 0; route < configuration.routes; ++route) {
+            rawRequests.push_back(MakeRawRequest(route, configuration));
+        }
+        const auto makeConnection = [&]{
+            const auto connection = std::make_shared< LoopbackConnection >();
+            connection->latencies = &latencies;
+            transport.connectionDelegate(connection);
+            return connection;
+        };
+        std::vector< std::shared_ptr< LoopbackConnection > > connections;
+        std::vector< size_t > requestsOnConnection(configuration.connections, 0);
+        for (size_t i = 0; i < configuration.connections; ++i) {
+            connections.push_back(makeConnection());
+        }
+        size_t requestsSent = 0;
+        size_t nextRoute = 0;
+        while (requestsSent < requestsToSend) {
+            for (
+                size_t i = 0;
+                (i < connections.size()) && (requestsSent < requestsToSend);
+                ++i
+            ) {
+                auto& connection = connections[i];
+                const auto batchSize = std::min(
+                    configuration.pipeline,
+                    requestsToSend - requestsSent
+                );
+                std::string batch;
+                {
+                    std::lock_guard< decltype(connection->mutex) > lock(connection->mutex);
+                    const auto now = std::chrono::steady_clock::now();
+                    for (size_t j = 0; j < batchSize; ++j) {
+                        batch += rawRequests[nextRoute];
+                        nextRoute = (nextRoute + 1) % configuration.routes;
+                        connection->sendTimes.push_back(now);
+                    }
+                }
+                connection->dataReceivedDelegate(
+                    std::vector< uint8_t >(batch.begin(), batch.end())
+                );
+                requestsSent += batchSize;
+                requestsOnConnection[i] += batchSize;
+                if (
+                    (configuration.churn != 0)
+                    && (requestsOnConnection[i] >= configuration.churn)
+                ) {
+                    connection->brokenDelegate(true);
+                    connection = makeConnection();
+                    requestsOnConnection[i] = 0;
+                }
+            }
+        }
+    }
+
+    /**
+     * This function returns the given percentile of the given sorted
+     * latencies.
+     *
+     * @param[in] sortedLatencies
+     *      These are the recorded latencies, sorted ascending.
+     *
+     * @param[in] fraction
+     *      This is the percentile to return, as a fraction.
+     *
+     * @return
+     *      The requested percentile is returned, in microseconds.
+     */
+    double Percentile(
+        const std::vector< double >& sortedLatencies,
+        double fraction
+    ) {
+        if (sortedLatencies.empty()) {
+            return 0.0;
+        }
+        const auto index = (size_t)(fraction * (double)(sortedLatencies.size() - 1));
+        return sortedLatencies[index];
+    }
+
+}
+
+int main(int argc, char* argv[]) {
+    HarnessConfiguration configuration;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        size_t value;
+        if (sscanf(argv[i + 1], "%zu", &value) != 1) {
+            (void)fprintf(stderr, "bad value for %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+        if (strcmp(argv[i], "--threads") == 0) {
+            configuration.threads = value;
+        } else if (strcmp(argv[i], "--connections") == 0) {
+            configuration.connections = value;
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            configuration.pipeline = value;
+        } else if (strcmp(argv[i], "--requests") == 0) {
+            configuration.requests = value;
+        } else if (strcmp(argv[i], "--body-size") == 0) {
+            configuration.bodySize = value;
+        } else if (strcmp(argv[i], "--routes") == 0) {
+            configuration.routes = value;
+        } else if (strcmp(argv[i], "--churn") == 0) {
+            configuration.churn = value;
+        } else if (strcmp(argv[i], "--workers") == 0) {
+            configuration.workers = value;
+        } else {
+            (void)fprintf(stderr, "unknown option %s\n", argv[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    Http::Server server;
+    server.SetConfigurationItem(
+        "WorkerThreads",
+        StringUtils::sprintf("%zu", configuration.workers)
+    );
+    std::vector< Http::IServer::UnregistrationDelegate > unregistrationDelegates;
+    for (size_t route = 0; route < configuration.routes; ++route) {
+        unregistrationDelegates.push_back(
+            server.RegisterResource(
+                {StringUtils::sprintf("r%zu", route)},
+                [](std::shared_ptr< Http::IServer::Request > request){
+                    const auto response = std::make_shared< Http::Client::Response >();
+                    response->statusCode = 200;
+                    response->status = "OK";
+                    response->headers.SetHeader("Content-Type", "text/plain");
+                    response->body = "Hello, World!\r\n";
+                    return response;
+                }
+            )
+        );
+    }
+    const auto transport = std::make_shared< LoopbackTransport >();
+    Http::Server::MobilizationDependencies dep = {transport, 1234};
+    dep.timeKeeper = std::make_shared< SteadyClockTimeKeeper >();
+    if (!server.Mobilize(dep)) {
+        (void)fprintf(stderr, "failed to mobilize the server\n");
+        return EXIT_FAILURE;
+    }
+    std::vector< std::vector< double > > latenciesPerThread(configuration.threads);
+    const auto allocationsBefore = allocationCount.load(std::memory_order_relaxed);
+    const auto startTime = std::chrono::steady_clock::now();
+    std::vector< std::thread > generators;
+    for (size_t i = 0; i < configuration.threads; ++i) {
+        const auto requestsToSend = (
+            configuration.requests / configuration.threads
+            + (
+                (i < configuration.requests % configuration.threads)
+                ? 1 : 0
+            )
+        );
+        generators.emplace_back(
+            GeneratorThread,
+            std::cref(configuration),
+            std::ref(*transport),
+            requestsToSend,
+            std::ref(latenciesPerThread[i])
+        );
+    }
+    for (auto& generator: generators) {
+        generator.join();
+    }
+    const auto elapsed = std::chrono::duration< double >(
+        std::chrono::steady_clock::now() - startTime
+    ).count();
+    const auto allocationsAfter = allocationCount.load(std::memory_order_relaxed);
+    server.Demobilize();
+    std::vector< double > latencies;
+    for (const auto& threadLatencies: latenciesPerThread) {
+        latencies.insert(
+            latencies.end(),
+            threadLatencies.begin(),
+            threadLatencies.end()
+        );
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto statistics = server.GetStatistics();
+    (void)printf("requests sent:        %zu\n", configuration.requests);
+    (void)printf("responses completed:  %zu\n", latencies.size());
+    (void)printf("elapsed:              %.3lf s\n", elapsed);
+    (void)printf("throughput:           %.0lf requests/s\n", (double)latencies.size() / elapsed);
+    (void)printf("allocations/request:  %.1lf\n",
+        (double)(allocationsAfter - allocationsBefore) / (double)configuration.requests
+    );
+    (void)printf("latency p50:          %.1lf us\n", Percentile(latencies, 0.50));
+    (void)printf("latency p90:          %.1lf us\n", Percentile(latencies, 0.90));
+    (void)printf("latency p99:          %.1lf us\n", Percentile(latencies, 0.99));
+    (void)printf("latency p99.9:        %.1lf us\n", Percentile(latencies, 0.999));
+    (void)printf("latency max:          %.1lf us\n", latencies.empty() ? 0.0 : latencies.back());
+    (void)printf("server requestsServed: %zu, parseErrors: %zu\n",
+        statistics.requestsServed,
+        statistics.parseErrors
+    );
+    (void)printf("server bytesReceived: %zu, bytesSent: %zu\n",
+        statistics.bytesReceived,
+        statistics.bytesSent
+    );
+    return EXIT_SUCCESS;
+}
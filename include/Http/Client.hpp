@@ -9,9 +9,12 @@
  * © 2024 by Hatem Nabli
  */
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <MessageHeaders/MessageHeaders.hpp>
+#include <Uri/Uri.hpp>
+#include "Connection.hpp"
 
 namespace Http {
 
@@ -24,6 +27,63 @@ namespace Http {
     public:
         struct Response
         {
+            // Types
+
+            /**
+             * This type is used to track how much of the response
+             * has been parsed so far.
+             */
+            enum class ResponseParsingState
+            {
+                /**
+                 * In this state, we're still waiting to receive
+                 * the full status line.
+                 */
+                StatusLine,
+
+                /**
+                 * In this state, we've received and parsed the status
+                 * line, and possibly some header lines, but haven't yet
+                 * received all of the header lines.
+                 */
+                Headers,
+
+                /**
+                 * In this state, we've received and parsed the status
+                 * line and headers, and possibly some of the body, but
+                 * haven't yet received all of the body.
+                 */
+                Body,
+
+                /**
+                 * In this state, the response is fully constructed.
+                 */
+                Complete,
+
+                /**
+                 * In this state, the response could not be parsed
+                 * and should be discarded.
+                 */
+                Error
+            };
+
+            /**
+             * This is the type of function a handler may install in a
+             * response to produce the body a piece at a time, rather
+             * than materializing it all at once in the body string.
+             * It's called repeatedly to pull the next piece of the body,
+             * and signals the end of the body by returning an empty
+             * string.
+             *
+             * @return
+             *      The next piece of the response body is returned.
+             *
+             * @retval ""
+             *      This is returned once the end of the body has been
+             *      reached.
+             */
+            typedef std::function< std::string() > BodyProducer;
+
             /**
              * This is the machine-readable number that describes
              * the overall status of the Response
@@ -47,8 +107,70 @@ namespace Http {
              */
             std::string body;
 
+            /**
+             * If this is set, the body of the response is produced by
+             * calling this function rather than taken from the body
+             * string, and the server streams it out with chunked
+             * transfer-encoding, so that the whole body never has to be
+             * held in memory at once.
+             */
+            BodyProducer bodyProducer;
+
+            /**
+             * If this is set, the body of the response is a region of
+             * the named file rather than the body string.  A server
+             * sending the response hands the region to the connection's
+             * file-sending capability when it has one, so that the file
+             * contents never pass through user space, and reads the
+             * region itself otherwise.
+             */
+            std::string bodyFilePath;
+
+            /**
+             * This is the offset, in bytes, of the start of the body
+             * within the file named by bodyFilePath.
+             */
+            size_t bodyFileOffset = 0;
+
+            /**
+             * This is the length, in bytes, of the body region of the
+             * file named by bodyFilePath.
+             */
+            size_t bodyFileLength = 0;
+
+            /**
+             * This tracks how much of the response has been parsed
+             * so far, so that parsing can resume where it left off
+             * when more data arrives.
+             */
+            ResponseParsingState state = ResponseParsingState::StatusLine;
+
+            /**
+             * This buffer accumulates the raw header block of the response
+             * while it's still being received, so that each new piece of
+             * data only has to be scanned once for the end of the headers.
+             */
+            std::string rawHeaders;
+
+            /**
+             * This is the offset into the raw header block of the start
+             * of the header line currently being received, which is where
+             * scanning resumes when more data arrives.
+             */
+            size_t headersLineStart = 0;
+
             //Methods
 
+            /**
+             * This method returns an indication of whether or not the
+             * response has been fully constructed (valid or not).
+             *
+             * @return
+             *      An indication of whether or not the response
+             *      has been fully constructed is returned.
+             */
+            bool IsProcessed() const;
+
             /**
              * This method generates the data to transmit to the client
              * to return this response to the client 
@@ -59,8 +181,101 @@ namespace Http {
              */
             std::string GenerateToString() const;
 
+            /**
+             * This method generates the data to transmit to the client
+             * to return this response to the client, appending it to
+             * the given output buffer.  Give the same buffer for every
+             * response sent through a connection, so that once it has
+             * grown to fit the connection's typical response, further
+             * responses serialize without allocating.
+             *
+             * @param[in,out] output
+             *      This is the buffer onto which to append the data
+             *      to transmit to the client.
+             */
+            void GenerateTo(std::string& output) const;
+
+        };
+
+        /**
+         * This represents an HTTP request to be sent to a server,
+         * decomposed into its various elements.
+         */
+        struct Request
+        {
+            /**
+             * This is the request method to be performed on the
+             * target resource.
+             */
+            std::string method;
+
+            /**
+             * This identifies the target resource upon which to apply
+             * the request.
+             */
+            Uri::Uri target;
+
+            /**
+             * This are the messages headers to include in the request.
+             */
+            MessageHeaders::MessageHeaders headers;
+
+            /**
+             * This is the body of the request, if there is a body.
+             */
+            std::string body;
+
+            //Methods
+
+            /**
+             * This method generates the data to transmit to the server
+             * to perform this request.
+             *
+             * @return
+             *      The data to transmit to the server to perform
+             *      this request is returned.
+             */
+            std::string GenerateToString() const;
         };
-        
+
+        /**
+         * This is the type of function to call once the response to a
+         * request sent through SendRequest has been fully received.
+         *
+         * @param[in] response
+         *      This is the response received for the request.
+         *
+         * @retval nullptr
+         *      This is given if the connection was broken before the
+         *      response could be received.
+         */
+        typedef std::function< void(std::shared_ptr< Response > response) > ResponseDelegate;
+
+        /**
+         * This is the type of function the client calls to establish a
+         * new connection to a server, binding the client to whatever
+         * transport the larger program uses.
+         *
+         * @param[in] hostNameOrAddress
+         *      This is the host name or address of the server to which
+         *      to connect.
+         *
+         * @param[in] port
+         *      This is the port number of the server to which to connect.
+         *
+         * @return
+         *      The new connection is returned.
+         *
+         * @retval nullptr
+         *      This is returned if a connection could not be established.
+         */
+        typedef std::function<
+            std::shared_ptr< Connection >(
+                const std::string& hostNameOrAddress,
+                uint16_t port
+            )
+        > ConnectionFactory;
+
     public:
         ~Client();
         Client(const Client&) = delete; // Copy Constructor that creates a new object by making a copy of an existing object. 
@@ -113,9 +328,69 @@ namespace Http {
         std::shared_ptr< Response > ParseResponse(const std::string& rawResponse, size_t& messageEnd);
 
         /**
-         * 
+         * This method is called one or more times to incrementally parse
+         * the given string as a raw Http response message, resuming from
+         * wherever the previous call left off, so that each arrival only
+         * examines new characters.
+         *
+         * @param[in, out] response
+         *      This is the response to parse.
+         *
+         * @param[in] nextRawResponsePart
+         *      This is the raw HTTP response message as a string.
+         *
+         * @param[in] offset
+         *      This is the offset into the given string of the first
+         *      character not yet consumed by a previous parse attempt.
+         *
+         * @return
+         *      The index just past the last character that was taken from
+         *      the given input string is returned.  Presumably, any
+         *      characters past this point belong to another message or
+         *      are outside the scope of HTTP.
+         */
+        size_t ParseResponse(
+            std::shared_ptr< Response > response,
+            const std::string& nextRawResponsePart,
+            size_t offset
+        );
+
+        /**
+         * This method sets the function the client calls to establish
+         * new connections to servers.  It must be set before any
+         * request can be sent.
+         *
+         * @param[in] connectionFactory
+         *      This is the function to call to establish a new
+         *      connection to a server.
          */
+        void SetConnectionFactory(ConnectionFactory connectionFactory);
 
+        /**
+         * This method sends the given request to the server identified
+         * by the request's target URI, calling the given delegate once
+         * the response has been fully received.  Connections are kept
+         * open and reused for subsequent requests to the same server,
+         * and multiple requests may be in flight on the same connection
+         * at once: they are pipelined, and responses are matched to
+         * requests in the order the requests were sent.
+         *
+         * @param[in] request
+         *      This is the request to send.
+         *
+         * @param[in] responseDelegate
+         *      This is the function to call once the response has been
+         *      fully received, or with nullptr if the connection was
+         *      broken before the response could be received.
+         *
+         * @return
+         *      An indication of whether or not the request could be
+         *      sent is returned.
+         */
+        bool SendRequest(
+            std::shared_ptr< Request > request,
+            ResponseDelegate responseDelegate
+        );
 
     private:
         /* data */
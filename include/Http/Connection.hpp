@@ -24,12 +24,14 @@ namespace Http {
 
         /**
          * This is the delegate used to deliver received data to the owner of 
-         * this interface.
+         * this interface.  Ownership of the buffer is transferred to
+         * the delegate, so the transport should move its receive buffer
+         * in rather than copying it.
          * 
          * @param[in] data
          *      This is the data that was received from the remote peer.
          */
-        typedef std::function< void(const std::vector< uint8_t >& data) > DataReceivedDelegate;
+        typedef std::function< void(std::vector< uint8_t >&& data) > DataReceivedDelegate;
 
         /**
          * This delegate is used to notify the user that the connection
@@ -37,6 +39,14 @@ namespace Http {
          */
         typedef std::function< void(bool graceful) > BrokenDelegate;
 
+        /**
+         * This is a sequence of separately-owned buffers to be sent to
+         * the remote peer as if they were one continuous sequence of
+         * bytes, so that the different parts of a message can be handed
+         * over without first being concatenated into a single buffer.
+         */
+        typedef std::vector< std::string > DataSegments;
+
 
         // Methods
     public:
@@ -79,6 +89,87 @@ namespace Http {
          */
         virtual void SendData(const std::vector< uint8_t >& data) = 0;
 
+        /**
+         * This method sends the given segments of data to the remote
+         * peer as one continuous sequence of bytes, taking ownership of
+         * the segments.  Implementations able to perform gather writes
+         * should override this to send the segments without copying
+         * them; the default implementation concatenates the segments
+         * and sends them through the single-buffer SendData.
+         *
+         * @param[in] segments
+         *      These are the segments of data to send to the remote peer.
+         */
+        virtual void SendData(DataSegments&& segments) {
+            size_t totalSize = 0;
+            for (const auto& segment: segments) {
+                totalSize += segment.size();
+            }
+            std::vector< uint8_t > data;
+            data.reserve(totalSize);
+            for (const auto& segment: segments) {
+                (void)data.insert(
+                    data.end(),
+                    segment.begin(),
+                    segment.end()
+                );
+            }
+            SendData(data);
+        }
+
+        /**
+         * This method sends the given region of the given file to the
+         * remote peer, as if its bytes had been passed to SendData.
+         * Implementations able to hand the file to the operating
+         * system (sendfile, TransmitFile, memory mapping) should
+         * override this to send the region without copying it through
+         * user space; the default implementation reports that the
+         * capability isn't available, in which case the caller should
+         * read the region itself and send it as ordinary data.
+         *
+         * @param[in] filePath
+         *      This is the path of the file whose region to send.
+         *
+         * @param[in] offset
+         *      This is the offset, in bytes, of the start of the
+         *      region within the file.
+         *
+         * @param[in] length
+         *      This is the length, in bytes, of the region to send.
+         *
+         * @return
+         *      An indication of whether or not the implementation was
+         *      able to send the file region is returned.
+         *
+         * @retval false
+         *      This is returned if the implementation doesn't have the
+         *      capability; nothing was sent, and the caller should
+         *      fall back to sending the region as ordinary data.
+         */
+        virtual bool SendFileRegion(
+            const std::string& filePath,
+            size_t offset,
+            size_t length
+        ) {
+            return false;
+        }
+
+        /**
+         * This method asks the transport to stop, or start again,
+         * delivering received data through the data received delegate,
+         * so that the owner of the connection can apply backpressure
+         * to a peer that sends faster than its responses drain.
+         * Implementations able to stop reading from the underlying
+         * socket should override this; the default implementation does
+         * nothing, in which case data simply continues to arrive.
+         *
+         * @param[in] paused
+         *      This flag indicates whether the delivery of received
+         *      data should be paused or resumed.
+         */
+        virtual void SetReceivePaused(bool paused) {
+        }
+
         /**
          * This method break the connection to the remote peer.
          * 
@@ -0,0 +1,78 @@
+#ifndef HTTP_FILE_SERVER_HPP
+#define HTTP_FILE_SERVER_HPP
+
+/**
+ * @file FileServer.hpp
+ *
+ * This module declares the Http::FileServer class
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include "IServer.hpp"
+
+#include <memory>
+#include <string>
+
+namespace Http {
+
+    /**
+     * This is a built-in resource which serves the files under a
+     * directory, suitable for registering with a server through
+     * RegisterResource.  The responses it produces reference the files
+     * by region rather than carrying their contents, so that a
+     * connection with a file-sending capability can hand the file to
+     * the operating system without ever copying it through user space,
+     * and information about recently served files is kept in a small
+     * cache so that hot files aren't re-examined on every request.
+     */
+    class FileServer {
+
+    public:
+        ~FileServer();
+        FileServer(const FileServer&) = delete;
+        FileServer(FileServer&&);
+        FileServer& operator=(const FileServer&) = delete;
+        FileServer& operator=(FileServer&&);
+
+    public:
+        /**
+        * This is the constructor.
+        *
+        * @param[in] rootDirectory
+        *      This is the path of the directory whose files should be
+        *      served.  Requests may only reach files under it; path
+        *      segments which would escape it are rejected.
+        */
+        explicit FileServer(const std::string& rootDirectory);
+
+        /**
+         * This method returns the resource delegate to register with a
+         * server in order to serve the files under the root directory.
+         * The file server must outlive any registration of the
+         * returned delegate.
+         *
+         * @return
+         *      The resource delegate to register with a server is
+         *      returned.
+         */
+        IServer::ResourceDelegate GetResourceDelegate();
+
+    private:
+        /* data */
+
+        /**
+         * This is the type of structure that contains the private
+         * properties of the instance. It is defined in the implementation
+         * and declared here to ensure that iwt is scoped inside the class.
+        */
+        struct Impl;
+
+        /**
+        * This contains the private properties of the instance.
+        */
+        std::unique_ptr<struct Impl> impl_;
+    };
+}
+
+#endif /* HTTP_FILE_SERVER_HPP */
@@ -81,6 +81,28 @@ namespace Http
 
             };
 
+            /**
+             * These are the standard request methods, interned as
+             * integer tokens when the request line is parsed, so that
+             * later stages can switch on the method rather than
+             * string-compare it again per request.
+             */
+            enum class KnownMethod
+            {
+                /**
+                 * The method is not one of the standard methods; its
+                 * text is still available in the method string.
+                 */
+                Unknown,
+                Get,
+                Head,
+                Post,
+                Put,
+                Delete,
+                Options,
+                Patch
+            };
+
             /**
              * This flag indicates whether or not the request
              * has passed all validity steps.
@@ -93,6 +115,12 @@ namespace Http
              */
             std::string method;
 
+            /**
+             * This is the interned token of the request method, if
+             * it's one of the standard methods.
+             */
+            KnownMethod knownMethod = KnownMethod::Unknown;
+
             /**
              * This identifies the target resource upon which to apply
              * the request.
@@ -117,6 +145,56 @@ namespace Http
              */
             RequestParsingState state = RequestParsingState::RequestLine;
 
+            /**
+             * This buffer accumulates the raw header block of the request
+             * while it's still being received, so that each new piece of
+             * data only has to be scanned once for the end of the headers.
+             */
+            std::string rawHeaders;
+
+            /**
+             * This is the offset into the raw header block of the start
+             * of the header line currently being received, which is where
+             * scanning resumes when more data arrives.
+             */
+            size_t headersLineStart = 0;
+
+            /**
+             * This flag indicates whether or not the request has a
+             * "Host" header.  It's cached here when the headers
+             * complete, so later stages don't re-search the header
+             * list.
+             */
+            bool hasHost = false;
+
+            /**
+             * This is the value of the request's "Host" header, if it
+             * has one, cached here when the headers complete.
+             */
+            std::string host;
+
+            /**
+             * This flag indicates whether or not the request has a
+             * "Content-Length" header, cached here when the headers
+             * complete.
+             */
+            bool hasContentLength = false;
+
+            /**
+             * This is the decoded value of the request's
+             * "Content-Length" header, if it has one, cached here when
+             * the headers complete.
+             */
+            size_t contentLength = 0;
+
+            /**
+             * This flag indicates whether or not the request carries a
+             * "Connection: close" token, cached here when the headers
+             * complete, so later stages don't allocate a vector of
+             * connection tokens just to look for it.
+             */
+            bool closeRequested = false;
+
             /**
              * If the state of the request is State::Error, or if
              * the request is not valid, this indicates the status
@@ -141,6 +219,14 @@ namespace Http
              *      has been fully constructed is returned.
              */
             bool IsProcessed() const;
+
+            /**
+             * This method returns the request to its freshly-constructed
+             * state, keeping the capacity of its internal buffers, so
+             * that the same object can be reused to parse another
+             * request without reallocating.
+             */
+            void Reset();
         };
 
         /**
@@ -158,6 +244,89 @@ namespace Http
                 std::shared_ptr<Request> request)>
             ResourceDelegate;
 
+        /**
+         * This is the type of the function returned by a streaming
+         * resource delegate, called to deliver each piece of the request
+         * body as it arrives, so that the server never has to hold the
+         * whole body in memory.
+         *
+         * @param[in] bodyData
+         *      This is the next piece of the request body.  It may be
+         *      empty when lastPiece is set.
+         *
+         * @param[in] lastPiece
+         *      This indicates whether or not the end of the request body
+         *      has been reached.
+         *
+         * @return
+         *      Once the last piece has been delivered, the response to
+         *      be returned to the client is returned.  For earlier
+         *      pieces, nullptr is returned.
+         */
+        typedef std::function<
+            std::shared_ptr<Client::Response>(
+                const std::string &bodyData,
+                bool lastPiece)>
+            RequestBodyDelegate;
+
+        /**
+         * This is the type of the function to be registered to handle
+         * HTTP requests whose bodies should be delivered incrementally
+         * rather than buffered.  It's called once the request line and
+         * headers have been received, before any of the body.
+         *
+         * @param[in] request
+         *      This is the request to apply to the resource.  Its body
+         *      is empty; the body is delivered through the returned
+         *      delegate instead.
+         *
+         * @return
+         *      The delegate to call with each piece of the request body
+         *      is returned.
+         */
+        typedef std::function<
+            RequestBodyDelegate(
+                std::shared_ptr<Request> request)>
+            StreamingResourceDelegate;
+
+        /**
+         * This is the type of function an asynchronous resource
+         * delegate calls, from any thread, once it has finished
+         * producing the response for a request.
+         *
+         * @param[in] response
+         *      This is the response to return to the client.  If
+         *      nullptr, the server returns an internal server error
+         *      response instead.
+         */
+        typedef std::function<
+            void(
+                std::shared_ptr<Client::Response> response)>
+            ResponseCompleteDelegate;
+
+        /**
+         * This is the type of the function to be registered to handle
+         * HTTP requests asynchronously: instead of returning a
+         * finished response, the handler is given a completion
+         * delegate to call once the response is ready, so that a
+         * handler which itself performs I/O doesn't block the server
+         * thread that called it.  The server keeps servicing other
+         * connections in the meantime, and responses on the same
+         * connection still go back in the order the requests came in.
+         *
+         * @param[in] request
+         *      This is the request to apply to the resource.
+         *
+         * @param[in] responseComplete
+         *      This is the function to call, from any thread, once
+         *      the response for the request is ready.
+         */
+        typedef std::function<
+            void(
+                std::shared_ptr<Request> request,
+                ResponseCompleteDelegate responseComplete)>
+            AsyncResourceDelegate;
+
         /**
          * This is the type of function returned by RegisterResource,
          * to be called when the resource should be unregistered from
@@ -233,6 +402,58 @@ namespace Http
         virtual UnregistrationDelegate RegisterResource(
             const std::vector<std::string> &resourceSubspacePath,
             ResourceDelegate resourceDelegate) = 0;
+
+        /**
+         * This method registers the given delegate to be called in order
+         * to generate a response for any request that comes in to the
+         * server with a target URI which identifies a resource within the
+         * given resource subspace of the server, with the request body
+         * delivered incrementally as it arrives rather than buffered, so
+         * that memory per request stays bounded no matter how large the
+         * body is.  Both Content-Length and chunked transfer framing are
+         * supported.
+         *
+         * @param[in] resourceSubspacePath
+         *      This identifies the subspace of resources that we want the
+         *      given delegate to be responsible for handling.
+         *
+         * @param[in] streamingResourceDelegate
+         *      This is the function to call, once the request line and
+         *      headers have been received, in order to obtain the
+         *      delegate through which the request body is delivered.
+         * @return
+         *      A function is returned which, if called, revokes the
+         *      registration of the resource delegate.
+         */
+        virtual UnregistrationDelegate RegisterStreamingResource(
+            const std::vector<std::string> &resourceSubspacePath,
+            StreamingResourceDelegate streamingResourceDelegate) = 0;
+
+        /**
+         * This method registers the given delegate to be called in
+         * order to produce, asynchronously, a response for any request
+         * that comes in to the server with a target URI which
+         * identifies a resource within the given resource subspace of
+         * the server.  The delegate is given a completion function to
+         * call once the response is ready, rather than having to
+         * return a finished response, so it may hand the work off and
+         * return immediately without blocking the calling thread.
+         *
+         * @param[in] resourceSubspacePath
+         *      This identifies the subspace of resources that we want
+         *      the given delegate to be responsible for handling.
+         *
+         * @param[in] asyncResourceDelegate
+         *      This is the function to call in order to begin handling
+         *      the given request; the response is delivered through
+         *      the completion delegate the function is given.
+         * @return
+         *      A function is returned which, if called, revokes the
+         *      registration of the resource delegate.
+         */
+        virtual UnregistrationDelegate RegisterAsyncResource(
+            const std::vector<std::string> &resourceSubspacePath,
+            AsyncResourceDelegate asyncResourceDelegate) = 0;
     };
     /**
      * This is a support function for googleTest to print out
@@ -17,6 +17,7 @@
 #include <ostream>
 #include <stdint.h>
 #include <string>
+#include <vector>
 #include <Uri/Uri.hpp>
 #include <Http/Client.hpp>
 #include <SystemUtils/DiagnosticsSender.hpp>
@@ -26,6 +27,25 @@ namespace Http {
     class Server: public IServer {
 
     public:
+        /**
+         * This pairs one transport layer with the port on which it
+         * should listen, for servers that accept connections through
+         * more than one listener.
+         */
+        struct TransportBinding
+        {
+            /**
+             * This is the transport layer implementation.
+             */
+            std::shared_ptr< ServerTransportLayer > transport;
+
+            /**
+             * This represents the port number to wich clients may connect
+             * to establish connections with the server.
+             */
+            uint16_t port;
+        };
+
         struct MobilizationDependencies
         {
             /* data */
@@ -42,8 +62,70 @@ namespace Http {
              * This represents the time keeper of the server.
              */
             std::shared_ptr< TimeKeeper > timeKeeper;
+            /**
+             * These are additional listeners to bind beyond the primary
+             * transport, either on other ports or on the same port
+             * where the platform shards accepts across listeners (as
+             * with SO_REUSEPORT).  Each listener's connections are kept
+             * on their own shard of the connection table, so accept and
+             * connection bookkeeping scale with the number of
+             * listeners.
+             */
+            std::vector< TransportBinding > extraBindings;
         };
-        
+
+        /**
+         * This is a snapshot of the counters the server keeps about the
+         * work it has done, suitable for periodic scraping into a
+         * metrics pipeline.  The counters are updated with atomic
+         * operations on the hot path, so taking a snapshot never blocks
+         * request processing.
+         */
+        struct Statistics
+        {
+            /**
+             * This is the total number of responses the server has sent
+             * back to clients, including canned error responses.
+             */
+            size_t requestsServed = 0;
+
+            /**
+             * This is the total number of bytes the server has received
+             * from clients.
+             */
+            size_t bytesReceived = 0;
+
+            /**
+             * This is the total number of bytes the server has sent
+             * back to clients.
+             */
+            size_t bytesSent = 0;
+
+            /**
+             * This is the total number of requests which could not be
+             * parsed or were rejected as invalid.
+             */
+            size_t parseErrors = 0;
+
+            /**
+             * This is the number of connections currently established
+             * with clients.
+             */
+            size_t activeConnections = 0;
+
+            /**
+             * This is a histogram of per-request service latencies,
+             * measured from when a fully-assembled request begins
+             * processing until its response has been handed to the
+             * connection.  Bucket i counts requests whose latency was at
+             * most 2^i microseconds, with the last bucket collecting
+             * everything longer.  All buckets are zero when the server
+             * has no time keeper.
+             */
+            std::vector< size_t > latencyBuckets;
+        };
+
+
 
         // LifeCycle managment
     public:
@@ -72,6 +154,16 @@ namespace Http {
          */
         bool Mobilize(const MobilizationDependencies& dependencies);
 
+        /**
+         * This method returns a snapshot of the counters the server
+         * keeps about the work it has done.  It may be called from any
+         * thread, at any rate, without slowing down request processing.
+         *
+         * @return
+         *      A snapshot of the server's statistics is returned.
+         */
+        Statistics GetStatistics();
+
         /**
          * This method stops any accepting or processing of client connections,
          * and releases the transport layer, returning the server back to the
@@ -182,10 +274,69 @@ namespace Http {
          *      formerly-registered delegate.
          */
         virtual UnregistrationDelegate RegisterResource(
-            const std::vector< std::string >& resourceSubspacePath, 
+            const std::vector< std::string >& resourceSubspacePath,
             ResourceDelegate resourceDelegate
         ) override;
-        
+
+        /**
+         * This method registers the given delegate to handle requests
+         * within the given resource subspace with the request body
+         * delivered incrementally as it arrives, rather than buffered,
+         * so that memory per request stays bounded no matter how large
+         * the body is.
+         *
+         * @param[in] resourceSubspacePath
+         *      This identifies the subspace of resources that we want the
+         *      given delegate to be responsible for handling.
+         *
+         * @param[in] streamingResourceDelegate
+         *      This is the function to call, once the request line and
+         *      headers have been received, in order to obtain the
+         *      delegate through which the request body is delivered.
+         * @return
+         *      A function is returned which, if called, revokes the
+         *      registration of the resource delegate.
+         */
+        virtual UnregistrationDelegate RegisterStreamingResource(
+            const std::vector< std::string >& resourceSubspacePath,
+            StreamingResourceDelegate streamingResourceDelegate
+        ) override;
+
+        virtual UnregistrationDelegate RegisterAsyncResource(
+            const std::vector< std::string >& resourceSubspacePath,
+            AsyncResourceDelegate asyncResourceDelegate
+        ) override;
+
+    private:
+        /**
+         * This method implements RegisterResource,
+         * RegisterStreamingResource, and RegisterAsyncResource,
+         * installing whichever of the delegates was provided in the
+         * given resource subspace.
+         *
+         * @param[in] resourceSubspacePath
+         *      This identifies the subspace of resources that we want the
+         *      given delegate to be responsible for handling.
+         *
+         * @param[in] resourceDelegate
+         *      This is the buffered-body delegate to install, if any.
+         *
+         * @param[in] streamingResourceDelegate
+         *      This is the streaming-body delegate to install, if any.
+         *
+         * @param[in] asyncResourceDelegate
+         *      This is the asynchronous delegate to install, if any.
+         * @return
+         *      A function is returned which, if called, revokes the
+         *      registration of the resource delegate.
+         */
+        UnregistrationDelegate RegisterResourceHandlers(
+            const std::vector< std::string >& resourceSubspacePath,
+            ResourceDelegate resourceDelegate,
+            StreamingResourceDelegate streamingResourceDelegate,
+            AsyncResourceDelegate asyncResourceDelegate
+        );
+
     private:
         /* data */
 
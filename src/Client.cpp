@@ -7,8 +7,12 @@
  * © 2024 by Hatem Nabli
  */
 
+#include <deque>
+#include <map>
+#include <mutex>
 #include <string>
 #include <sstream>
+#include <vector>
 #include <Http/Client.hpp>
 #include <StringUtils/StringUtils.hpp>
 
@@ -20,6 +24,33 @@ namespace {
      */
     const std::string CRLF("\r\n");
 
+    /**
+     * This function appends the decimal form of the given number onto
+     * the given output buffer, without going through iostreams or
+     * printf-style formatting.
+     *
+     * @param[in] number
+     *      This is the number to format.
+     *
+     * @param[in,out] output
+     *      This is the buffer onto which to append the formatted
+     *      number.
+     */
+    void AppendDecimal(
+        unsigned int number,
+        std::string& output
+    ) {
+        char digits[10];
+        size_t numDigits = 0;
+        do {
+            digits[numDigits++] = (char)('0' + (number % 10));
+            number /= 10;
+        } while (number != 0);
+        while (numDigits != 0) {
+            output += digits[--numDigits];
+        }
+    }
+
     /**
      * @return 
      *      An indication of whether or not the number was parsed
@@ -102,6 +133,86 @@ namespace {
         return (protocol == "HTTP/1.1");
     }
 
+    /**
+     * This is the default port used to connect to a server whose URI
+     * doesn't specify one.
+     */
+    constexpr uint16_t DEFAULT_HTTP_PORT = 80;
+
+    /**
+     * This is the amount of consumed space allowed to accumulate at
+     * the front of a connection's receive buffer before the buffer
+     * is compacted.
+     */
+    constexpr size_t RECEIVE_BUFFER_COMPACTION_THRESHOLD = 65536;
+
+    /**
+     * This represents one request sent on a connection whose response
+     * hasn't been fully received yet.
+     */
+    struct Transaction {
+
+        /**
+         * This is the response being assembled for the request.
+         */
+        std::shared_ptr< Http::Client::Response > response = std::make_shared< Http::Client::Response >();
+
+        /**
+         * This is the function to call once the response has been
+         * fully received (or with nullptr if the connection was
+         * broken first).
+         */
+        Http::Client::ResponseDelegate responseDelegate;
+    };
+
+    /**
+     * This holds onto all state information the client has about a
+     * single persistent connection to a server.
+     */
+    struct ConnectionState {
+
+        /**
+         * This is the transport interface of the connection.
+         */
+        std::shared_ptr< Http::Connection > connection;
+
+        /**
+         * This is the key ("host:port") under which the connection is
+         * held for reuse.
+         */
+        std::string key;
+
+        /**
+         * This buffer is used to reassemble fragmented HTTP responses
+         * received from the server, tracking consumed characters by
+         * offset rather than erasing them from the front.
+         */
+        std::string receiveBuffer;
+
+        /**
+         * This is the number of characters at the front of the receive
+         * buffer which have already been consumed.
+         */
+        size_t consumed = 0;
+
+        /**
+         * These are the requests in flight on this connection, in the
+         * order they were sent, which is the order in which the server
+         * will answer them.
+         */
+        std::deque< Transaction > pendingTransactions;
+
+        /**
+         * This serializes sends through the connection, covering both
+         * the enqueue of a transaction and the write of its request
+         * bytes, so that the order of pendingTransactions always
+         * matches the order the requests went out on the wire.  The
+         * responses are matched to the pending transactions in order,
+         * so the two orders must never diverge.
+         */
+        std::mutex sendMutex;
+    };
+
 }
 
 namespace Http {
@@ -111,14 +222,241 @@ namespace Http {
      */
     struct Client::Impl
     {
-        
+        /**
+         * This is the public interface of the client, through which
+         * the incremental response parser is reached.
+         */
+        Client* self = nullptr;
+
+        /**
+         * This is used to synchronize access to the client's state.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is the function to call to establish a new connection
+         * to a server.
+         */
+        ConnectionFactory connectionFactory;
+
+        /**
+         * These are the persistent connections currently established
+         * with servers, keyed by "host:port".
+         */
+        std::map< std::string, std::shared_ptr< ConnectionState > > connections;
+
+        /**
+         * This method is called whenever data arrives on a connection.
+         * Responses are parsed incrementally and matched to the pending
+         * transactions in the order the requests were sent; each
+         * completed response is handed to its transaction's delegate.
+         *
+         * @param[in] connectionState
+         *      This is the state of the connection on which the data
+         *      arrived.
+         *
+         * @param[in] data
+         *      This is the data that arrived.
+         */
+        void DataReceived(
+            std::shared_ptr< ConnectionState > connectionState,
+            const std::vector< uint8_t >& data
+        ) {
+            std::vector< Transaction > completedTransactions;
+            bool connectionRuined = false;
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                connectionState->receiveBuffer.append(data.begin(), data.end());
+                while (!connectionState->pendingTransactions.empty()) {
+                    auto& transaction = connectionState->pendingTransactions.front();
+                    connectionState->consumed = self->ParseResponse(
+                        transaction.response,
+                        connectionState->receiveBuffer,
+                        connectionState->consumed
+                    );
+                    if (transaction.response->state == Response::ResponseParsingState::Complete) {
+                        completedTransactions.push_back(std::move(transaction));
+                        connectionState->pendingTransactions.pop_front();
+                    } else if (transaction.response->state == Response::ResponseParsingState::Error) {
+                        connectionRuined = true;
+                        break;
+                    } else {
+                        break;
+                    }
+                }
+                if (
+                    connectionState->pendingTransactions.empty()
+                    && (connectionState->consumed < connectionState->receiveBuffer.length())
+                ) {
+                    // The server sent bytes no outstanding request
+                    // asked for; fail the connection rather than let
+                    // a misbehaving server grow an idle connection's
+                    // buffer without bound.
+                    connectionRuined = true;
+                }
+                if (connectionState->consumed == connectionState->receiveBuffer.length()) {
+                    connectionState->receiveBuffer.clear();
+                    connectionState->consumed = 0;
+                } else if (connectionState->consumed > RECEIVE_BUFFER_COMPACTION_THRESHOLD) {
+                    (void)connectionState->receiveBuffer.erase(0, connectionState->consumed);
+                    connectionState->consumed = 0;
+                }
+            }
+            for (auto& completedTransaction: completedTransactions) {
+                completedTransaction.responseDelegate(completedTransaction.response);
+            }
+            if (connectionRuined) {
+                FailConnection(connectionState);
+                connectionState->connection->Break(false);
+            }
+        }
+
+        /**
+         * This method is called when a connection is broken or ruined:
+         * it's removed from the pool, and all of its in-flight
+         * transactions are completed with nullptr.
+         *
+         * @param[in] connectionState
+         *      This is the state of the connection that failed.
+         */
+        void FailConnection(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            std::deque< Transaction > failedTransactions;
+            {
+                std::lock_guard< decltype(mutex) > lock(mutex);
+                failedTransactions = std::move(connectionState->pendingTransactions);
+                connectionState->pendingTransactions.clear();
+                (void)connections.erase(connectionState->key);
+            }
+            for (auto& failedTransaction: failedTransactions) {
+                failedTransaction.responseDelegate(nullptr);
+            }
+        }
+
+        /**
+         * This method returns the connection to use to reach the given
+         * server, reusing the pooled connection if one is open, and
+         * establishing one through the connection factory otherwise.
+         * The caller must hold the client's mutex.
+         *
+         * @param[in] host
+         *      This is the host name or address of the server.
+         *
+         * @param[in] port
+         *      This is the port number of the server.
+         *
+         * @return
+         *      The state of the connection to use is returned.
+         *
+         * @retval nullptr
+         *      This is returned if a connection could not be established.
+         */
+        std::shared_ptr< ConnectionState > GetConnection(
+            const std::string& host,
+            uint16_t port
+        ) {
+            const auto key = StringUtils::sprintf("%s:%u", host.c_str(), (unsigned int)port);
+            const auto connectionsEntry = connections.find(key);
+            if (connectionsEntry != connections.end()) {
+                return connectionsEntry->second;
+            }
+            if (connectionFactory == nullptr) {
+                return nullptr;
+            }
+            const auto connection = connectionFactory(host, port);
+            if (connection == nullptr) {
+                return nullptr;
+            }
+            const auto connectionState = std::make_shared< ConnectionState >();
+            connectionState->connection = connection;
+            connectionState->key = key;
+            connections[key] = connectionState;
+            std::weak_ptr< ConnectionState > connectionStateWeak(connectionState);
+            connection->SetDataReceivedDelegate(
+                [this, connectionStateWeak](std::vector< uint8_t >&& data){
+                    const auto connectionState = connectionStateWeak.lock();
+                    if (connectionState == nullptr) {
+                        return;
+                    }
+                    DataReceived(connectionState, data);
+                }
+            );
+            connection->SetConnectionBrokenDelegate(
+                [this, connectionStateWeak](bool graceful){
+                    const auto connectionState = connectionStateWeak.lock();
+                    if (connectionState == nullptr) {
+                        return;
+                    }
+                    FailConnection(connectionState);
+                }
+            );
+            return connectionState;
+        }
     };
 
     Client::~Client() = default;
 
     Client::Client()
          : impl_(new Impl) {
+            impl_->self = this;
+    }
 
+    void Client::SetConnectionFactory(ConnectionFactory connectionFactory) {
+        std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+        impl_->connectionFactory = connectionFactory;
+    }
+
+    bool Client::SendRequest(
+        std::shared_ptr< Request > request,
+        ResponseDelegate responseDelegate
+    ) {
+        const auto host = request->target.GetHost();
+        if (host.empty()) {
+            return false;
+        }
+        const auto port = (
+            request->target.HasPort()
+            ? request->target.GetPort()
+            : DEFAULT_HTTP_PORT
+        );
+        if (!request->headers.HasHeader("Host")) {
+            request->headers.SetHeader("Host", host);
+        }
+        if (
+            !request->body.empty()
+            && !request->headers.HasHeader("Content-Length")
+        ) {
+            request->headers.SetHeader(
+                "Content-Length",
+                StringUtils::sprintf("%zu", request->body.length())
+            );
+        }
+        std::shared_ptr< ConnectionState > connectionState;
+        {
+            std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+            connectionState = impl_->GetConnection(host, port);
+            if (connectionState == nullptr) {
+                return false;
+            }
+        }
+        const auto rawRequest = request->GenerateToString();
+        // The enqueue of the transaction and the write of the request
+        // bytes happen under the connection's send mutex, so that two
+        // threads sending through the same connection can't enqueue
+        // their transactions in one order and put their bytes on the
+        // wire in the other.
+        std::lock_guard< decltype(connectionState->sendMutex) > sendLock(connectionState->sendMutex);
+        {
+            std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+            Transaction transaction;
+            transaction.responseDelegate = responseDelegate;
+            connectionState->pendingTransactions.push_back(std::move(transaction));
+        }
+        connectionState->connection->SendData(
+            std::vector< uint8_t >(rawRequest.begin(), rawRequest.end())
+        );
+        return true;
     }
     
     auto Client::ParseResponse(const std::string& rawResponse)-> std::shared_ptr< Response > {
@@ -128,66 +466,157 @@ namespace Http {
 
     auto Client::ParseResponse(const std::string& rawResponse, size_t& messageEnd)-> std::shared_ptr< Response > {
         const auto response = std::make_shared< Response >();
-        // First, extarct the response line.
-        const auto responseLineEnd = rawResponse.find(CRLF);
-        if (responseLineEnd == std::string::npos) {
+        messageEnd = ParseResponse(response, rawResponse, 0);
+        if (response->state != Response::ResponseParsingState::Complete) {
             return nullptr;
         }
-        const auto responseLine = rawResponse.substr(0, responseLineEnd);
-        if (!ParseResponseLine(response, responseLine)) {
-            return nullptr;
+        return response;
+    }
+
+    size_t Client::ParseResponse(
+        std::shared_ptr< Response > response,
+        const std::string& nextRawResponsePart,
+        size_t offset
+    ) {
+        // Index just past the last character incorporated into
+        // the response object.
+        size_t messageEnd = offset;
+        if (response->state == Response::ResponseParsingState::StatusLine) {
+            // First, extarct the response line.
+            const auto responseLineEnd = nextRawResponsePart.find(CRLF, offset);
+            if (responseLineEnd == std::string::npos) {
+                return messageEnd;
+            }
+            const auto responseLine = nextRawResponsePart.substr(offset, responseLineEnd - offset);
+            if (!ParseResponseLine(response, responseLine)) {
+                response->state = Response::ResponseParsingState::Error;
+                return messageEnd;
+            }
+            messageEnd = responseLineEnd + CRLF.length();
+            response->state = Response::ResponseParsingState::Headers;
         }
         //Second, parse the message headers and identify where the body begins.
-        size_t bodyOffset;
-        size_t headerOffset = responseLineEnd + CRLF.length();
-        switch (
-            response->headers
-                .ParseRawMessage(
-                    rawResponse.substr(headerOffset),
-                    bodyOffset
-                )
-        ) {
-            case MessageHeaders::MessageHeaders::State::Complete: {
-                if (!response->headers.IsValid()) {
-                    return nullptr;
+        if (response->state == Response::ResponseParsingState::Headers) {
+            // Accumulate the new characters onto the response's raw
+            // header block, and scan only the characters not scanned
+            // before for the end of the headers, so that headers which
+            // trickle in over many packets aren't re-copied and
+            // re-scanned on every arrival.
+            const auto priorHeadersLength = response->rawHeaders.length();
+            response->rawHeaders.append(
+                nextRawResponsePart,
+                messageEnd,
+                std::string::npos
+            );
+            auto searchStart = response->headersLineStart;
+            if (priorHeadersLength > searchStart + 1) {
+                // Back up one character in case a CRLF straddles
+                // the boundary between two arrivals.
+                searchStart = priorHeadersLength - 1;
+            }
+            size_t headersEnd = std::string::npos;
+            for (;;) {
+                const auto lineEnd = response->rawHeaders.find(CRLF, searchStart);
+                if (lineEnd == std::string::npos) {
+                    return nextRawResponsePart.length();
                 }
-            } break;
-            case MessageHeaders::MessageHeaders::State::Incomplete: return nullptr;
-            case MessageHeaders::MessageHeaders::State::Error: return nullptr;
-            default: return nullptr;
-        }
-        // Check for "Content-Length" header, if present, use it to
-        // determine how many characters should be in the body.
-        bodyOffset += headerOffset;
-        const auto maxContentLength = rawResponse.length() - bodyOffset;
-        // If it containt "Content-Length" header, we carefully carve exactly
-        // that number of cahracters out (and bail if we don't have anough) 
-        if (response->headers.HasHeader("Content-Length")) {
-            size_t contentLength;
-            if (!ParseSize(response->headers.GetHeaderValue("Content-Length"), contentLength)) {
-                return nullptr;
+                if (lineEnd == response->headersLineStart) {
+                    // An empty line marks the end of the headers.
+                    headersEnd = lineEnd + CRLF.length();
+                    break;
+                }
+                response->headersLineStart = lineEnd + CRLF.length();
+                searchStart = response->headersLineStart;
             }
-            if (contentLength > maxContentLength) {
-                return nullptr;
+            // Give back any characters received beyond the end of the
+            // headers; they belong to the body or to the next message.
+            messageEnd = (
+                nextRawResponsePart.length()
+                - (response->rawHeaders.length() - headersEnd)
+            );
+            response->rawHeaders.resize(headersEnd);
+            size_t bodyOffset = 0;
+            if (
+                response->headers.ParseRawMessage(
+                    response->rawHeaders,
+                    bodyOffset
+                ) != MessageHeaders::MessageHeaders::State::Complete
+            ) {
+                response->state = Response::ResponseParsingState::Error;
+                return messageEnd;
+            }
+            if (!response->headers.IsValid()) {
+                response->state = Response::ResponseParsingState::Error;
+                return messageEnd;
+            }
+            response->state = Response::ResponseParsingState::Body;
+        }
+        // Finally, extract the body.
+        if (response->state == Response::ResponseParsingState::Body) {
+            // Check for "Content-Length" header, if present, use it to
+            // determine how many characters should be in the body.
+            const auto bodyAvailableSize = nextRawResponsePart.length() - messageEnd;
+            // If it containt "Content-Length" header, we carefully carve exactly
+            // that number of cahracters out (and bail if we don't have anough)
+            if (response->headers.HasHeader("Content-Length")) {
+                size_t contentLength;
+                if (!ParseSize(response->headers.GetHeaderValue("Content-Length"), contentLength)) {
+                    response->state = Response::ResponseParsingState::Error;
+                    return messageEnd;
+                }
+                if (contentLength > bodyAvailableSize) {
+                    return messageEnd;
+                } else {
+                    response->body = nextRawResponsePart.substr(messageEnd, contentLength);
+                    messageEnd += contentLength;
+                    response->state = Response::ResponseParsingState::Complete;
+                }
             } else {
-                response->body = rawResponse.substr(bodyOffset, contentLength);
-                messageEnd = bodyOffset + contentLength;
+                //Finally, extract the body
+                response->body.clear();
+                response->state = Response::ResponseParsingState::Complete;
             }
-        } else {
-            //Finally, extract the body
-            response->body.clear();
-            messageEnd = bodyOffset;
         }
+        return messageEnd;
+    }
 
-        return response;
+    bool Client::Response::IsProcessed() const {
+        return (
+            (state == ResponseParsingState::Complete)
+            || (state == ResponseParsingState::Error)
+        );
     }
 
-    std::string Client::Response::GenerateToString() const {
+    std::string Client::Request::GenerateToString() const {
         std::ostringstream builder;
-        builder << "HTTP/1.1 " << statusCode << ' ' << status << "\r\n";
+        builder << method << ' ' << target.GenerateString() << " HTTP/1.1\r\n";
         builder << headers.GenerateRawHeaders();
         builder << body;
         return builder.str();
     }
 
+    std::string Client::Response::GenerateToString() const {
+        std::string output;
+        GenerateTo(output);
+        return output;
+    }
+
+    void Client::Response::GenerateTo(std::string& output) const {
+        const auto rawHeaders = headers.GenerateRawHeaders();
+        output.reserve(
+            output.length()
+            + 15
+            + status.length()
+            + rawHeaders.length()
+            + body.length()
+        );
+        output += "HTTP/1.1 ";
+        AppendDecimal(statusCode, output);
+        output += ' ';
+        output += status;
+        output += CRLF;
+        output += rawHeaders;
+        output += body;
+    }
+
 }
\ No newline at end of file
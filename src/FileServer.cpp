@@ -0,0 +1,257 @@
+/**
+ * @file FileServer.cpp
+ *
+ * This module is an implementation of the
+ * Http::FileServer class.
+ *
+ * © 2024 by Hatem Nabli
+ */
+
+#include <Http/FileServer.hpp>
+
+#include <fstream>
+#include <list>
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace {
+
+    /**
+     * This is the maximum number of files whose information is kept in
+     * the file information cache.  When the cache is full, the file
+     * least recently served is evicted to make room.
+     */
+    constexpr size_t FILE_INFO_CACHE_LIMIT = 16;
+
+    /**
+     * This holds what the file server needs to know about one file in
+     * order to produce a response for it, cached so that hot files
+     * don't have their content types re-guessed on every request.
+     * The size is revalidated on every hit, since the file may change
+     * behind the server's back.
+     */
+    struct FileInfo {
+
+        /**
+         * This is the size of the file, in bytes.
+         */
+        size_t size = 0;
+
+        /**
+         * This is the value to give for the "Content-Type" header of
+         * responses serving the file, guessed from its extension.
+         */
+        std::string contentType;
+    };
+
+    /**
+     * This function guesses the content type of the file with the
+     * given path from the file's extension.
+     *
+     * @param[in] path
+     *      This is the path of the file whose content type to guess.
+     *
+     * @return
+     *      The guessed content type of the file is returned.  If the
+     *      extension isn't recognized, "application/octet-stream" is
+     *      returned.
+     */
+    std::string GuessContentType(const std::string& path) {
+        static const std::map< std::string, std::string > contentTypes{
+            {"css", "text/css"},
+            {"gif", "image/gif"},
+            {"htm", "text/html"},
+            {"html", "text/html"},
+            {"jpeg", "image/jpeg"},
+            {"jpg", "image/jpeg"},
+            {"js", "application/javascript"},
+            {"json", "application/json"},
+            {"png", "image/png"},
+            {"svg", "image/svg+xml"},
+            {"txt", "text/plain"},
+        };
+        const auto delimiter = path.find_last_of('.');
+        if (delimiter == std::string::npos) {
+            return "application/octet-stream";
+        }
+        const auto contentType = contentTypes.find(path.substr(delimiter + 1));
+        if (contentType == contentTypes.end()) {
+            return "application/octet-stream";
+        }
+        return contentType->second;
+    }
+
+}
+
+namespace Http {
+
+    /**
+     * This contains the private properties of a FileServer instance.
+     */
+    struct FileServer::Impl {
+
+        /**
+         * This is one entry of the file information cache.
+         */
+        struct CacheEntry {
+
+            /**
+             * This is the cached information about the file.
+             */
+            FileInfo info;
+
+            /**
+             * This locates the file in the recency list, so that
+             * serving the file again can move it to the front in
+             * constant time.
+             */
+            std::list< std::string >::iterator recencyEntry;
+        };
+
+        /**
+         * This is the path of the directory whose files are served.
+         */
+        std::string rootDirectory;
+
+        /**
+         * This is used to synchronize access to the file information
+         * cache, since requests for files may be served concurrently.
+         */
+        std::mutex mutex;
+
+        /**
+         * This is the cache of information about recently served
+         * files, keyed by their paths relative to the root directory.
+         */
+        std::map< std::string, CacheEntry > cache;
+
+        /**
+         * These are the relative paths of the cached files, most
+         * recently served first, used to pick the file to evict when
+         * the cache is full.
+         */
+        std::list< std::string > recency;
+
+        /**
+         * This method looks up the information the file server needs
+         * about the file with the given path relative to the root
+         * directory, from the cache when the file was served recently,
+         * and from the file itself otherwise.
+         *
+         * @param[in] relativePath
+         *      This is the path of the file, relative to the root
+         *      directory.
+         *
+         * @param[out] info
+         *      This is where to store the information about the file.
+         *
+         * @return
+         *      An indication of whether or not the file exists and
+         *      could be examined is returned.
+         */
+        bool GetFileInfo(
+            const std::string& relativePath,
+            FileInfo& info
+        ) {
+            std::lock_guard< decltype(mutex) > lock(mutex);
+            auto entry = cache.find(relativePath);
+            if (entry != cache.end()) {
+                // Revalidate the cached size, so a file deleted or
+                // truncated since it was cached doesn't produce a
+                // response promising bytes the file no longer has.
+                std::ifstream file(
+                    rootDirectory + "/" + relativePath,
+                    std::ios::binary | std::ios::ate
+                );
+                if (!file) {
+                    recency.erase(entry->second.recencyEntry);
+                    (void)cache.erase(entry);
+                    return false;
+                }
+                entry->second.info.size = (size_t)file.tellg();
+                recency.splice(
+                    recency.begin(),
+                    recency,
+                    entry->second.recencyEntry
+                );
+                info = entry->second.info;
+                return true;
+            }
+            std::ifstream file(
+                rootDirectory + "/" + relativePath,
+                std::ios::binary | std::ios::ate
+            );
+            if (!file) {
+                return false;
+            }
+            info.size = (size_t)file.tellg();
+            info.contentType = GuessContentType(relativePath);
+            recency.push_front(relativePath);
+            cache[relativePath] = {info, recency.begin()};
+            if (cache.size() > FILE_INFO_CACHE_LIMIT) {
+                (void)cache.erase(recency.back());
+                recency.pop_back();
+            }
+            return true;
+        }
+
+    };
+
+    FileServer::~FileServer() = default;
+
+    FileServer::FileServer(FileServer&&) = default;
+    FileServer& FileServer::operator=(FileServer&&) = default;
+
+    FileServer::FileServer(const std::string& rootDirectory)
+        : impl_(new Impl) {
+        impl_->rootDirectory = rootDirectory;
+    }
+
+    auto FileServer::GetResourceDelegate() -> IServer::ResourceDelegate {
+        const auto impl = impl_.get();
+        return [impl](
+            std::shared_ptr< IServer::Request > request
+        ) -> std::shared_ptr< Client::Response > {
+            const auto response = std::make_shared< Client::Response >();
+            // Build the path of the file relative to the root
+            // directory, rejecting any segment which could escape it.
+            std::string relativePath;
+            bool acceptable = true;
+            for (const auto& segment: request->target.GetPath()) {
+                if (
+                    segment.empty()
+                    || (segment == ".")
+                    || (segment == "..")
+                ) {
+                    acceptable = false;
+                    break;
+                }
+                if (!relativePath.empty()) {
+                    relativePath += '/';
+                }
+                relativePath += segment;
+            }
+            FileInfo info;
+            if (
+                !acceptable
+                || relativePath.empty()
+                || !impl->GetFileInfo(relativePath, info)
+            ) {
+                response->statusCode = 404;
+                response->status = "Not Found";
+                response->headers.SetHeader("Content-Type", "text/plain");
+                response->body = "Not Found\r\n";
+                return response;
+            }
+            response->statusCode = 200;
+            response->status = "OK";
+            response->headers.SetHeader("Content-Type", info.contentType);
+            response->bodyFilePath = impl->rootDirectory + "/" + relativePath;
+            response->bodyFileOffset = 0;
+            response->bodyFileLength = info.size;
+            return response;
+        };
+    }
+
+}
@@ -7,6 +7,7 @@
  * © 2024 by Hatem Nabli
  */
 
+#include <algorithm>
 #include <set>
 #include <map>
 #include <deque>
@@ -14,10 +15,18 @@
 #include <StringUtils/StringUtils.hpp>
 #include <string>
 #include <Http/Server.hpp>
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstring>
+#include <fstream>
 #include <thread>
 #include <memory>
 #include <mutex>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace {
     /**
@@ -27,6 +36,40 @@ namespace {
      */
     const std::string CRLF("\r\n");
 
+    /**
+     * This is the interim response sent to tell a client which asked
+     * for "100-continue" that it should go ahead and send the request
+     * body.
+     */
+    const std::string CONTINUE_RESPONSE("HTTP/1.1 100 Continue\r\n\r\n");
+
+    /**
+     * This function appends the decimal form of the given number onto
+     * the given output buffer, without going through iostreams or
+     * printf-style formatting.
+     *
+     * @param[in] number
+     *      This is the number to format.
+     *
+     * @param[in,out] output
+     *      This is the buffer onto which to append the formatted
+     *      number.
+     */
+    void AppendDecimal(
+        unsigned int number,
+        std::string& output
+    ) {
+        char digits[10];
+        size_t numDigits = 0;
+        do {
+            digits[numDigits++] = (char)('0' + (number % 10));
+            number /= 10;
+        } while (number != 0);
+        while (numDigits != 0) {
+            output += digits[--numDigits];
+        }
+    }
+
     /**
      * This is the maximum allowed request body size.
      */
@@ -37,6 +80,117 @@ namespace {
      */
     constexpr size_t DEFAULT_HEADER_LINE_LIMIT = 1000;
 
+    /**
+     * This is the default number of worker threads used to dispatch
+     * resource delegates.  Zero means requests are handled directly
+     * on the thread that received the data.
+     */
+    constexpr size_t DEFAULT_WORKER_THREADS = 0;
+
+    /**
+     * This is the default maximum number of seconds a connection may go
+     * without any data arriving before the server closes it.
+     */
+    constexpr double DEFAULT_INACTIVITY_TIMEOUT_SECONDS = 300.0;
+
+    /**
+     * This is the default maximum number of seconds the server will wait
+     * for the header section of a request to be completely received,
+     * measured from the arrival of its first byte.
+     */
+    constexpr double DEFAULT_REQUEST_TIMEOUT_SECONDS = 60.0;
+
+    /**
+     * This is the default maximum number of bytes one connection may
+     * hold in its receive buffer and partially-assembled request
+     * before the server rejects the request and closes the
+     * connection.  It matches the maximum allowed content length, so
+     * any request the server would accept still fits.
+     */
+    constexpr size_t DEFAULT_CONNECTION_BUFFER_LIMIT = 10000000;
+
+    /**
+     * This is the default maximum number of bytes the server may hold
+     * across all connections' receive buffers and partially-assembled
+     * requests.  Zero means no aggregate limit is enforced.
+     */
+    constexpr size_t DEFAULT_TOTAL_BUFFER_LIMIT = 0;
+
+    /**
+     * This is the number of slots in the timer wheel used to track
+     * connection timeouts.
+     */
+    constexpr size_t TIMER_WHEEL_NUM_SLOTS = 64;
+
+    /**
+     * This is the span of time, in seconds, covered by one slot of the
+     * timer wheel.
+     */
+    constexpr double TIMER_WHEEL_SLOT_SECONDS = 1.0;
+
+    /**
+     * This is the interval, in milliseconds, at which the timer thread
+     * wakes up to consult the time keeper and advance the timer wheel.
+     */
+    constexpr unsigned int TIMER_POLL_MILLISECONDS = 100;
+
+    /**
+     * This is the number of buckets in the request latency histogram.
+     * Bucket i counts requests whose service latency was at most 2^i
+     * microseconds, with the last bucket collecting everything longer.
+     */
+    constexpr size_t LATENCY_BUCKET_COUNT = 20;
+
+    /**
+     * This is a typed snapshot of the configuration items the server
+     * consults while processing requests.  A new snapshot is built and
+     * published (by atomic shared_ptr swap) whenever a configuration
+     * item changes, so the hot paths read plain fields from an
+     * immutable structure with no locking or map lookups per request.
+     */
+    struct ServerConfiguration {
+
+        /**
+         * This is the name by which the server knows itself, used to
+         * validate the "Host" header of incoming requests.  If empty,
+         * any host is accepted.
+         */
+        std::string host;
+
+        /**
+         * This is the maximum allowed request header line size.
+         */
+        size_t headerLineLimit = DEFAULT_HEADER_LINE_LIMIT;
+
+        /**
+         * This is the maximum number of seconds a connection may go
+         * without any data arriving before the server closes it.
+         */
+        double inactivityTimeout = DEFAULT_INACTIVITY_TIMEOUT_SECONDS;
+
+        /**
+         * This is the maximum number of seconds the server will wait
+         * for the header section of a request to be completely
+         * received, measured from the arrival of its first byte.
+         */
+        double requestTimeout = DEFAULT_REQUEST_TIMEOUT_SECONDS;
+
+        /**
+         * This is the maximum number of bytes one connection may hold
+         * in its receive buffer and partially-assembled request before
+         * the server rejects the request and closes the connection.
+         */
+        size_t connectionBufferLimit = DEFAULT_CONNECTION_BUFFER_LIMIT;
+
+        /**
+         * This is the maximum number of bytes the server may hold
+         * across all connections' receive buffers and
+         * partially-assembled requests.  Zero means no aggregate limit
+         * is enforced.
+         */
+        size_t totalBufferLimit = DEFAULT_TOTAL_BUFFER_LIMIT;
+    };
+
     enum ParseSizeResult {
         /**
          * this indicates the size was parsed successfully. 
@@ -81,7 +235,123 @@ namespace {
         return ParseSizeResult::Success;
     }
 
-    
+    /**
+     * This function locates the next CRLF sequence in the given string,
+     * starting from the given offset.  The scan is vectorized: sixteen
+     * bytes are examined per step where SSE2 is available, with memchr
+     * (itself vectorized in common C libraries) as the portable
+     * fallback, since byte-at-a-time scanning dominates the parse
+     * profile for typical request sizes.
+     *
+     * @param[in] haystack
+     *      This is the string to scan.
+     *
+     * @param[in] offset
+     *      This is the offset into the string at which to begin the scan.
+     *
+     * @return
+     *      The offset of the start of the next CRLF sequence is returned.
+     *
+     * @retval std::string::npos
+     *      This is returned if the string contains no CRLF sequence at
+     *      or after the given offset.
+     */
+    size_t FindCRLF(const std::string& haystack, size_t offset) {
+        const auto* data = haystack.data();
+        const auto length = haystack.length();
+        auto i = offset;
+#if defined(__SSE2__)
+        const auto carriageReturns = _mm_set1_epi8('\r');
+        while (i + 16 <= length) {
+            const auto block = _mm_loadu_si128((const __m128i*)(data + i));
+            auto mask = (unsigned int)_mm_movemask_epi8(
+                _mm_cmpeq_epi8(block, carriageReturns)
+            );
+            while (mask != 0) {
+                const auto candidate = i + (size_t)__builtin_ctz(mask);
+                if (
+                    (candidate + 1 < length)
+                    && (data[candidate + 1] == '\n')
+                ) {
+                    return candidate;
+                }
+                mask &= (mask - 1);
+            }
+            i += 16;
+        }
+#endif
+        while (i < length) {
+            const auto* cr = (const char*)memchr(data + i, '\r', length - i);
+            if (cr == nullptr) {
+                return std::string::npos;
+            }
+            const auto candidate = (size_t)(cr - data);
+            if (candidate + 1 >= length) {
+                return std::string::npos;
+            }
+            if (data[candidate + 1] == '\n') {
+                return candidate;
+            }
+            i = candidate + 1;
+        }
+        return std::string::npos;
+    }
+
+    /**
+     * This function recognizes the standard request methods by their
+     * length plus a single exact comparison, interning the method as
+     * an integer token so later stages can switch on it rather than
+     * string-compare the method again.
+     *
+     * @param[in] method
+     *      This points to the first character of the method.
+     *
+     * @param[in] methodLength
+     *      This is the length of the method, in characters.
+     *
+     * @return
+     *      The interned token of the method is returned.
+     */
+    Http::Server::Request::KnownMethod InternMethod(
+        const char* method,
+        size_t methodLength
+    ) {
+        typedef Http::Server::Request::KnownMethod KnownMethod;
+        switch (methodLength) {
+            case 3: {
+                if (memcmp(method, "GET", 3) == 0) {
+                    return KnownMethod::Get;
+                }
+                if (memcmp(method, "PUT", 3) == 0) {
+                    return KnownMethod::Put;
+                }
+            } break;
+            case 4: {
+                if (memcmp(method, "HEAD", 4) == 0) {
+                    return KnownMethod::Head;
+                }
+                if (memcmp(method, "POST", 4) == 0) {
+                    return KnownMethod::Post;
+                }
+            } break;
+            case 5: {
+                if (memcmp(method, "PATCH", 5) == 0) {
+                    return KnownMethod::Patch;
+                }
+            } break;
+            case 6: {
+                if (memcmp(method, "DELETE", 6) == 0) {
+                    return KnownMethod::Delete;
+                }
+            } break;
+            case 7: {
+                if (memcmp(method, "OPTIONS", 7) == 0) {
+                    return KnownMethod::Options;
+                }
+            } break;
+        }
+        return KnownMethod::Unknown;
+    }
 
     /**
      * This method parses the method, target URI, and protocol identifier
@@ -91,550 +361,2661 @@ namespace {
      *      This is the request in which to store the parsed method and 
      *      target URI.
      * 
-     * @param[in] requestLine
-     *      This is the raw request line string to parse.
-     * 
+     * @param[in] rawRequest
+     *      This is the raw request string containing the request line.
+     *
+     * @param[in] lineBegin
+     *      This is the offset into the raw request string of the first
+     *      character of the request line.
+     *
+     * @param[in] lineEnd
+     *      This is the offset into the raw request string just past the
+     *      last character of the request line (before the CRLF).
+     *
      * @return
      *      Returns an indication of whether or not the request line
-     *      was successfuly parsed 
+     *      was successfuly parsed
      */
-    bool ParseRequestLine(std::shared_ptr< Http::Server::Request > request, const std::string& requestLine) {
+    bool ParseRequestLine(
+        std::shared_ptr< Http::Server::Request > request,
+        const std::string& rawRequest,
+        size_t lineBegin,
+        size_t lineEnd
+    ) {
+        // The pieces of the request line are sliced as pointer/length
+        // views into the raw request, so that only the pieces which are
+        // kept (the method and target) are ever copied.
+        const auto* line = rawRequest.data() + lineBegin;
+        const auto lineLength = lineEnd - lineBegin;
 
         //Parse the method
-        const auto methodDelimiter = requestLine.find(' ');
-        if (methodDelimiter == std::string::npos) {
+        const auto* methodEnd = (const char*)memchr(line, ' ', lineLength);
+        if (methodEnd == nullptr) {
             return false;
         }
-
-        request->method = requestLine.substr(0, methodDelimiter);
-        if (request->method.empty()) {
+        const auto methodLength = (size_t)(methodEnd - line);
+        if (methodLength == 0) {
             return false;
         }
+        request->method.assign(line, methodLength);
+        request->knownMethod = InternMethod(line, methodLength);
 
         // Parse the target URI.
-        const auto targetDelimiter = requestLine.find(' ', methodDelimiter + 1);
-        const auto targetLength = targetDelimiter - methodDelimiter -1;
+        const auto* targetBegin = methodEnd + 1;
+        const auto* targetEnd = (const char*)memchr(
+            targetBegin,
+            ' ',
+            (size_t)(line + lineLength - targetBegin)
+        );
+        if (targetEnd == nullptr) {
+            return false;
+        }
+        const auto targetLength = (size_t)(targetEnd - targetBegin);
         if (targetLength == 0 ) {
             return false;
         }
-        if (!request->target.ParseFromString(
-                requestLine.substr(
-                    methodDelimiter + 1, 
-                    targetDelimiter - methodDelimiter - 1 
-                )
+        if (
+            (targetLength > 1)
+            && (targetBegin[0] == '/')
+            && (memchr(targetBegin, '?', targetLength) == nullptr)
+            && (memchr(targetBegin, '#', targetLength) == nullptr)
+            && (memchr(targetBegin, '%', targetLength) == nullptr)
+        ) {
+            // Fast path for plain origin-form targets, which are the
+            // overwhelming majority of traffic: a target which begins
+            // with a slash and carries no query, fragment, or percent
+            // encoding is nothing but a path, so its segments can be
+            // split off directly, without dragging the target through
+            // the generic URI parser's scheme, authority, and query
+            // machinery.
+            std::vector< std::string > path;
+            path.push_back("");
+            const auto* segmentBegin = targetBegin + 1;
+            const auto* pastTarget = targetBegin + targetLength;
+            for (;;) {
+                const auto* segmentEnd = (const char*)memchr(
+                    segmentBegin,
+                    '/',
+                    (size_t)(pastTarget - segmentBegin)
+                );
+                if (segmentEnd == nullptr) {
+                    path.emplace_back(segmentBegin, (size_t)(pastTarget - segmentBegin));
+                    break;
+                }
+                path.emplace_back(segmentBegin, (size_t)(segmentEnd - segmentBegin));
+                segmentBegin = segmentEnd + 1;
+            }
+            request->target = Uri::Uri();
+            request->target.SetPath(path);
+        } else if (!request->target.ParseFromString(
+                std::string(targetBegin, targetLength)
             )
         ){
             return false;
         }
 
-        // Parse the protocol.
-        const auto protocol = requestLine.substr(targetDelimiter + 1);
-
-        return (protocol == "HTTP/1.1");
+        // Parse the protocol.  The only accepted protocol is exactly
+        // "HTTP/1.1", so a length check plus one eight-byte comparison
+        // suffices.
+        const auto* protocolBegin = targetEnd + 1;
+        const auto protocolLength = (size_t)(line + lineLength - protocolBegin);
+        return (
+            (protocolLength == 8)
+            && (memcmp(protocolBegin, "HTTP/1.1", 8) == 0)
+        );
     }
 
        
 
     /**
-     *  This structure holds onto all state information the server has
-     *  about a single connection from a client.
+     * This holds a response that the server sends without consulting
+     * any handler, pre-serialized once so that sending it requires
+     * no formatting or allocation at all.
      */
-    struct ConnectionState {
+    struct CannedResponse {
 
         /**
-         * This is the transport interface of the connection.
+         * This is the machine-readable number that describes
+         * the overall status of the response.
          */
-        std::shared_ptr< Http::Connection > connection;
+        unsigned int statusCode;
 
         /**
-         * This buffer is used to conctatenate fragmented HTTP requests
-         * received from the client.
+         * This is the human-readable text that describes
+         * the overall status of the response.
          */
-        std::string concatenateBuffer;
+        std::string status;
 
         /**
-         * This is the state of the next request, while it's still
-         * being received and parsed.
+         * These are the pre-serialized bytes of the complete response,
+         * ready to be handed directly to the connection.
          */
-        std::shared_ptr< Http::Server::Request > nextRequest = std::make_shared< Http::Server::Request>();
-
+        std::string data;
     };
 
     /**
-     * This is used to record what resources are currently supported
-     * by the server, and through which handler delegates.
+     * This function returns the pre-serialized canned response for the
+     * given status code.  The table of canned responses is built once,
+     * the first time it's needed.
+     *
+     * @param[in] statusCode
+     *      This is the status code of the canned response to return.
+     *
+     * @return
+     *      The canned response for the given status code is returned.
+     *      If the status code isn't recognized, the 400 "Bad Request"
+     *      response is returned.
      */
-    struct ResourceSpace
-    {
+    const CannedResponse& GetCannedResponse(unsigned int statusCode) {
+        const auto MakeCannedResponse = [](
+            unsigned int statusCode,
+            const std::string& status
+        ){
+            const auto text = StringUtils::sprintf(
+                "HTTP/1.1 %u %s\r\n"
+                "Content-Length: 13\r\n"
+                "Content-Type: text/plain\r\n"
+                "\r\n"
+                "BadRequest.\r\n",
+                statusCode,
+                status.c_str()
+            );
+            return CannedResponse{
+                statusCode,
+                status,
+                text
+            };
+        };
+        static const std::map< unsigned int, CannedResponse > cannedResponses{
+            {400, MakeCannedResponse(400, "Bad Request")},
+            {404, MakeCannedResponse(404, "Not Found")},
+            {413, MakeCannedResponse(413, "Payload Too Large")},
+            {431, MakeCannedResponse(431, "Request Header Fields Too Large")},
+            {500, MakeCannedResponse(500, "Internal Server Error")},
+        };
+        auto cannedResponse = cannedResponses.find(statusCode);
+        if (cannedResponse == cannedResponses.end()) {
+            cannedResponse = cannedResponses.find(400);
+        }
+        return cannedResponse->second;
+    }
+
+    /**
+     * This is the number of consumed bytes allowed to accumulate at the
+     * front of a receive buffer before the buffer is compacted.
+     */
+    constexpr size_t RECEIVE_BUFFER_COMPACTION_THRESHOLD = 65536;
+
+    /**
+     * This is the maximum number of spare request objects kept per
+     * connection to be recycled across the connection's lifetime.
+     */
+    constexpr size_t REQUEST_POOL_LIMIT = 8;
+
+    /**
+     * This is a receive buffer which tracks how many bytes at the front
+     * have already been consumed by the parser, rather than erasing them,
+     * so that accepting bytes doesn't shift the remainder of the buffer.
+     * Consumed bytes are only reclaimed all at once, either when the
+     * buffer is fully consumed or when enough of them have piled up.
+     */
+    struct ReceiveBuffer {
+
         /**
-         * This is the name of the resource space, used as the key
-         * to find it amoung all the subspaces of the supersapce.
+         * This holds the raw bytes received from the client, including
+         * any bytes at the front which have already been consumed.
          */
-        std::string name;
+        std::string data;
 
         /**
-         * This is the delegate to call to handler any resource request
-         * within this space. If nullptr, the space is divided into 
-         * subspaces.
+         * This is the offset into the data of the first byte
+         * not yet consumed by the parser.
          */
-        Http::Server::ResourceDelegate handler;
+        size_t consumed = 0;
 
         /**
-         * If the space is divided into subspaces, these are the subspaces
-         * which have currently registered handler delegates
+         * This method appends the given data to the end of the buffer.
+         *
+         * @param[in] moreData
+         *      This is the data to append to the buffer.
          */
-        std::map< std::string, std::shared_ptr< ResourceSpace > > subspaces;
+        void Append(const std::string& moreData) {
+            data += moreData;
+        }
 
         /**
-         * This points back to the resource superspace containing
-         * this subspace. 
+         * This method appends the given received bytes to the end of
+         * the buffer, directly, without first converting them to a
+         * string.
+         *
+         * @param[in] moreData
+         *      This is the data to append to the buffer.
          */
-        std::weak_ptr< ResourceSpace > superspace;
-    };
-    
+        void Append(const std::vector< uint8_t >& moreData) {
+            data.append(
+                reinterpret_cast< const char* >(moreData.data()),
+                moreData.size()
+            );
+        }
 
-}
+        /**
+         * This method marks the given number of unconsumed bytes as
+         * consumed, compacting the buffer if the consumed prefix has
+         * grown large enough to be worth reclaiming.
+         *
+         * @param[in] count
+         *      This is the number of bytes to consume.
+         */
+        void Consume(size_t count) {
+            consumed += count;
+            if (consumed == data.length()) {
+                data.clear();
+                consumed = 0;
+            } else if (consumed > RECEIVE_BUFFER_COMPACTION_THRESHOLD) {
+                data.erase(0, consumed);
+                consumed = 0;
+            }
+        }
 
-namespace Http {
+        /**
+         * @return
+         *      The number of bytes received but not yet consumed
+         *      is returned.
+         */
+        size_t Available() const {
+            return data.length() - consumed;
+        }
+    };
 
     /**
-     * This contains the private properties of a Server instance
+     * This type is used to track how much of a chunked-framed request
+     * body has been decoded so far.
      */
+    enum class ChunkDecodeState {
+        /**
+         * In this state, we're waiting to receive the full
+         * chunk-size line.
+         */
+        Size,
 
-    struct Server::Impl
-    {
+        /**
+         * In this state, we're receiving the data of a chunk.
+         */
+        Data,
 
-        // Properties
+        /**
+         * In this state, we're waiting for the CRLF which
+         * follows the data of a chunk.
+         */
+        DataCrlf,
 
         /**
-         * This is the pointer to the server who own the connection.
+         * In this state, we've seen the last (empty) chunk and are
+         * consuming any trailer lines up to the final empty line.
          */
-        Server* server = nullptr;
+        Trailer
+    };
+
+    /**
+     *  This structure holds onto all state information the server has
+     *  about a single connection from a client.
+     */
+    /**
+     * This is the slot held for the response to one request whose
+     * handler is asynchronous (or which is queued behind one), so that
+     * responses still go back in the order the requests came in even
+     * when their handlers complete out of order.
+     */
+    struct PendingResponse {
 
         /**
-         * this holds configuration items of the server.
+         * This flag indicates whether or not the response for the
+         * slot's request is ready to be sent.
          */
-        std::map< std::string, std::string> configuration;
+        bool ready = false;
 
         /**
-         * This is the header line limit parameter
+         * This is the response to send, once ready.  If ready and
+         * nullptr, a canned response with the canned status code is
+         * sent instead.
          */
-        size_t headerLineLimit = DEFAULT_HEADER_LINE_LIMIT;
+        std::shared_ptr< Http::Client::Response > response;
 
         /**
-         * This is the transport layer currently bound.
+         * This is the status code of the canned response to send, if
+         * the slot holds a canned response rather than a full one.
+         * If zero and the response is nullptr, the handler failed to
+         * produce a response, and an internal server error is sent.
          */
-        std::shared_ptr< ServerTransportLayer > transport;
-        
+        unsigned int cannedStatusCode = 0;
+
         /**
-         * These are the currently established connections.
+         * This flag indicates whether or not the connection should be
+         * closed once the slot's response has been sent.
          */
-        std::set< std::shared_ptr< ConnectionState > > establishedConnections;
+        bool closeAfter = false;
+    };
+
+    struct ConnectionState {
 
         /**
-         * These are the client connections that have been broken an will
-         * be destroyed by the reaper thread.
+         * This is the transport interface of the connection.
          */
-        std::set< std::shared_ptr< ConnectionState > > brokenConnections;
+        std::shared_ptr< Http::Connection > connection;
 
         /**
-         * This is a helper object used to generate and publish
-         * diagnostic messages.
+         * This is used to synchronize access to the state of this
+         * connection only, so that data received on independent
+         * connections can be parsed and handled concurrently.  It's
+         * recursive so that an asynchronous handler which completes
+         * its response synchronously, from within the dispatch call
+         * itself, doesn't deadlock.
          */
-        SystemUtils::DiagnosticsSender diagnosticsSender;
+        std::recursive_mutex mutex;
 
         /**
-         * This is a worker thread whose jobe is to clear the
-         * brokenConnections set. The reason we need to put broken
-         * connections there in the first place is because we can't
-         * destroy a connection that is in the process of calling
-         * us through one of the delegates we gave it.
+         * This buffer is used to reassemble fragmented HTTP requests
+         * received from the client, tracking consumed bytes by offset
+         * rather than erasing them from the front.
          */
-        std::thread reaper;
+        ReceiveBuffer receiveBuffer;
 
         /**
-         * This represents the entire space of resources under the server.
+         * This is the state of the next request, while it's still
+         * being received and parsed.
          */
-        std::shared_ptr< ResourceSpace > resources;
+        std::shared_ptr< Http::Server::Request > nextRequest = std::make_shared< Http::Server::Request>();
 
         /**
-         * This flag indicates whether or not the reaper thread should stop.
+         * These are the requests which have been fully assembled on this
+         * connection and are waiting to be handled by a worker thread.
          */
-        bool stopReaper = false;
+        std::deque< std::shared_ptr< Http::Server::Request > > requestsReady;
 
         /**
-         * This is used to synchronize access to the server.
+         * This flag indicates whether or not this connection is currently
+         * queued for (or being serviced by) a worker thread.  It's used
+         * to make sure only one worker services the connection at a time,
+         * so that responses go back in the order the requests came in.
          */
-        std::mutex mutex;
+        bool workerScheduled = false;
 
         /**
-         * This is used by the reaper thread to wait on any
-         * condition that it should cause it to wake up.
+         * This flag indicates whether or not a decision has been made,
+         * for the request currently being received, about whether its
+         * body should be streamed to the handler or buffered.
          */
-        std::condition_variable condition;
+        bool bodyStreamingDecided = false;
 
         /**
-         * This is the constructor for the structure
+         * This is the request whose body is currently being streamed
+         * to its handler, if any.
          */
-        Impl(): diagnosticsSender("Http::Server"){
+        std::shared_ptr< Http::Server::Request > streamingRequest;
 
-        }
+        /**
+         * This is the delegate through which the body of the request
+         * currently being streamed is delivered.
+         */
+        Http::Server::RequestBodyDelegate bodyDelegate;
 
         /**
-         * This method is the body of the reaper thread.
-         * Until it's told to stop, it simply clears the
-         * brokenConnections set whenever it wakes up.
+         * This flag indicates whether or not the body currently being
+         * streamed uses chunked transfer framing rather than a
+         * declared content length.
          */
-        void Reaper() {
-            std::unique_lock< decltype(mutex) > lock(mutex);
-            while (!stopReaper) {
-                std::set< std::shared_ptr< ConnectionState > > oldBrokenConnections(std::move(brokenConnections));
-                brokenConnections.clear();
-                {
-                    lock.unlock();
-                    oldBrokenConnections.clear();
-                    lock.lock();
-                }
-                condition.wait(
-                    lock,
-                    [this]{
-                        return (
-                            stopReaper || !brokenConnections.empty()
-                        );
-                    }
-                );
-            }
-        }
+        bool chunkedBody = false;
 
-           /**
-         * This method appends the given data to the end of the concatenate
-         * buffer, and then attempts to parse a request out of it.
-         * 
-         * @param[in] server
-         *      This is the server that has this connection.
-         * 
-         * @return 
-         *      The request parsed from the concatenate buffer is returned.
-         * 
-         * @retval nullptr
-         *      This is returned if no request could be parsed from the 
-         *      concatinate buffer
+        /**
+         * This tracks how much of the current chunk of a chunked-framed
+         * body has been decoded so far.
          */
-        std::shared_ptr< Request > TryRequestAssembly(
-            std::shared_ptr< ConnectionState > connectionState
-        ) {
-            const auto charactersAccepted =  ParseRequest(
-                connectionState->nextRequest,
-                connectionState->concatenateBuffer
-            );
-            connectionState->concatenateBuffer.erase(
-                connectionState->concatenateBuffer.begin(),
-                connectionState->concatenateBuffer.begin() + charactersAccepted
-            );
+        ChunkDecodeState chunkState = ChunkDecodeState::Size;
+
+        /**
+         * This is the number of body (or chunk data) bytes which are
+         * still expected for the request currently being streamed.
+         */
+        size_t bodyBytesRemaining = 0;
+
+        /**
+         * These are the segments of response data generated while
+         * servicing the current batch of requests, held back so that
+         * all the responses produced by one data-arrival event go out
+         * through a single gather write rather than one write per
+         * response.
+         */
+        Http::Connection::DataSegments outputSegments;
+
+        /**
+         * This buffer is used to serialize the status line and headers
+         * of each response sent back through the connection, written
+         * directly with plain appends rather than through iostreams or
+         * printf-style formatting.  Its contents are copied out as one
+         * gather-write segment per response; the buffer itself, and
+         * the capacity it has grown, stay with the connection for its
+         * whole lifetime, so steady-state serialization doesn't
+         * allocate beyond the segment itself.
+         */
+        std::string serializationBuffer;
+
+        /**
+         * These are the slots held, in request order, for responses
+         * not yet ready to be sent: the responses of requests with
+         * asynchronous handlers, and any responses completed behind
+         * them which have to wait their turn.
+         */
+        std::deque< std::shared_ptr< PendingResponse > > pendingResponses;
+
+        /**
+         * This flag indicates whether or not a parked response is
+         * currently being sent, so that the send isn't mistaken for a
+         * new response that has to wait behind the pending slots.
+         */
+        bool sendingParkedResponse = false;
+
+        /**
+         * This is the index of the connection table shard holding this
+         * connection, which is the shard belonging to the listener
+         * through which the connection was accepted.
+         */
+        size_t shard = 0;
+
+        /**
+         * This is the number of buffered bytes this connection is
+         * currently charged for against the server's aggregate buffer
+         * budget, so that the charge can be adjusted by deltas and
+         * released exactly once when the connection goes away.
+         */
+        size_t accountedBufferBytes = 0;
+
+        /**
+         * This flag indicates whether or not the server has asked the
+         * transport to stop delivering received data on this
+         * connection, because its buffered requests haven't drained
+         * yet.
+         */
+        bool receivePaused = false;
+
+        /**
+         * This is the time, according to the time keeper, at which data
+         * last arrived on this connection (or at which the connection
+         * was established), used to detect idle connections.
+         */
+        double lastActivityTime = 0.0;
+
+        /**
+         * This is the time, according to the time keeper, at which the
+         * first byte of the header section currently being received
+         * arrived, or zero if no header section is in progress, used to
+         * detect clients that trickle their headers in.
+         */
+        double requestStartTime = 0.0;
+
+        /**
+         * These are spare request objects which have already served a
+         * request on this connection and can be reused for the next one,
+         * so that keep-alive connections don't pay for a fresh request
+         * object (and its internal buffers) per request.
+         */
+        std::vector< std::shared_ptr< Http::Server::Request > > requestPool;
+
+        // Methods
+
+        /**
+         * This method returns a request object ready to parse the next
+         * request, recycled from the pool if one is available.
+         *
+         * @return
+         *      A request object ready for parsing is returned.
+         */
+        std::shared_ptr< Http::Server::Request > FetchRequest() {
+            if (requestPool.empty()) {
+                return std::make_shared< Http::Server::Request >();
+            }
+            auto request = std::move(requestPool.back());
+            requestPool.pop_back();
+            return request;
+        }
+
+        /**
+         * This method returns the given request object to the pool,
+         * unless something else is still holding onto it or the pool
+         * is already full.
+         *
+         * @param[in] request
+         *      This is the request object to recycle.
+         */
+        void RecycleRequest(std::shared_ptr< Http::Server::Request >&& request) {
+            if (
+                (request.use_count() == 1)
+                && (requestPool.size() < REQUEST_POOL_LIMIT)
+            ) {
+                request->Reset();
+                requestPool.push_back(std::move(request));
+            }
+        }
+
+    };
+
+    /**
+     * This is one link in the lock-free list of connections waiting to
+     * be destroyed by the reaper thread.  Connection-broken delegates
+     * push these onto an atomic list head with a compare-and-swap, and
+     * the reaper takes the whole list at once with an exchange, so
+     * that handing a connection over to the reaper never takes a lock
+     * shared with anything else.
+     */
+    struct BrokenConnectionNode
+    {
+        /**
+         * This is the connection to be destroyed by the reaper thread.
+         */
+        std::shared_ptr< ConnectionState > connectionState;
+
+        /**
+         * This is the next link in the list, or nullptr at the end.
+         */
+        BrokenConnectionNode* next = nullptr;
+    };
+
+    /**
+     * This is one shard of the server's connection table.  Each
+     * listener's connections live on their own shard, with their own
+     * mutex, so that accepting and reaping connections on one listener
+     * never contends with bookkeeping for another listener's
+     * connections.
+     */
+    struct ConnectionShard
+    {
+        /**
+         * This is used to synchronize access to the shard's set of
+         * established connections.
+         */
+        std::mutex mutex;
+
+        /**
+         * These are the currently established connections accepted
+         * through this shard's listener.
+         */
+        std::set< std::shared_ptr< ConnectionState > > establishedConnections;
+    };
+
+    /**
+     * This is used to record what resources are currently supported
+     * by the server, and through which handler delegates.
+     */
+    struct ResourceSpace
+    {
+        /**
+         * This is the name of the resource space, used as the key
+         * to find it amoung all the subspaces of the supersapce.
+         */
+        std::string name;
+
+        /**
+         * This is the delegate to call to handler any resource request
+         * within this space. If nullptr, the space is divided into
+         * subspaces.
+         */
+        Http::Server::ResourceDelegate handler;
+
+        /**
+         * This is the delegate to call, instead of the buffered-body
+         * handler, for resources whose request bodies should be
+         * delivered incrementally as they arrive.
+         */
+        Http::Server::StreamingResourceDelegate streamingHandler;
+
+        /**
+         * This is the delegate to call, instead of the others, for
+         * resources whose responses are produced asynchronously
+         * through a completion delegate.
+         */
+        Http::Server::AsyncResourceDelegate asyncHandler;
+
+        /**
+         * If the space is divided into subspaces, these are the subspaces
+         * which have currently registered handler delegates
+         */
+        std::map< std::string, std::shared_ptr< ResourceSpace > > subspaces;
+
+        /**
+         * This points back to the resource superspace containing
+         * this subspace.
+         */
+        std::weak_ptr< ResourceSpace > superspace;
+    };
+
+    /**
+     * These are the handler delegates resolved for one subspace of the
+     * route table.  At most one of them is set.
+     */
+    struct RouteHandlers {
+
+        /**
+         * This is the delegate to call to handle any resource request
+         * within the subspace, with the request body buffered.
+         */
+        Http::Server::ResourceDelegate handler;
+
+        /**
+         * This is the delegate to call to handle any resource request
+         * within the subspace, with the request body delivered
+         * incrementally as it arrives.
+         */
+        Http::Server::StreamingResourceDelegate streamingHandler;
+
+        /**
+         * This is the delegate to call to handle any resource request
+         * within the subspace whose response is produced
+         * asynchronously through a completion delegate.
+         */
+        Http::Server::AsyncResourceDelegate asyncHandler;
+    };
+
+    /**
+     * This is one node of the flattened route table.  The children of a
+     * node are stored contiguously, ordered by segment, so that matching
+     * a path segment is a binary search over a cache-friendly range
+     * rather than a red-black-tree lookup per level.
+     */
+    struct RouteTableNode {
+
+        /**
+         * This is the path segment matched by this node.
+         */
+        std::string segment;
+
+        /**
+         * These are the handler delegates for the space matched by this
+         * node.  If neither is set, the space is divided into subspaces.
+         */
+        RouteHandlers handlers;
+
+        /**
+         * This is the index into the table of the first child
+         * of this node.
+         */
+        size_t firstChild = 0;
+
+        /**
+         * This is the number of children of this node.
+         */
+        size_t childCount = 0;
+    };
+
+    /**
+     * This is a flattened, read-only form of the registered resource
+     * tree, rebuilt whenever a resource is registered or unregistered,
+     * and used to route requests to their handler delegates.
+     */
+    struct RouteTable {
+
+        /**
+         * These are the nodes of the flattened resource tree.  The
+         * children of any node (including the root) occupy a contiguous
+         * range, ordered by segment.
+         */
+        std::vector< RouteTableNode > nodes;
+
+        /**
+         * These are the handler delegates registered for the entire
+         * resource space, if any.
+         */
+        RouteHandlers rootHandlers;
+
+        /**
+         * This is the index into the table of the first top-level node.
+         */
+        size_t rootFirstChild = 0;
+
+        /**
+         * This is the number of top-level nodes.
+         */
+        size_t rootChildCount = 0;
+
+        /**
+         * This method matches the given resource path against the route
+         * table, descending as far as the table and the path allow,
+         * without copying any path segments.
+         *
+         * @param[in] path
+         *      These are the segments of the resource path to match.
+         *
+         * @param[in] firstSegment
+         *      This is the index of the first path segment to match.
+         *
+         * @param[out] segmentsMatched
+         *      This is set to the index just past the last path segment
+         *      that was matched; any segments beyond it identify the
+         *      resource within the matched subspace.
+         *
+         * @return
+         *      The handler delegates registered for the deepest matched
+         *      subspace are returned.  Neither delegate is set if no
+         *      handler covers the given path.
+         */
+        const RouteHandlers& Match(
+            const std::vector< std::string >& path,
+            size_t firstSegment,
+            size_t& segmentsMatched
+        ) const {
+            const RouteHandlers* handlers = &rootHandlers;
+            auto firstChild = rootFirstChild;
+            auto childCount = rootChildCount;
+            auto segment = firstSegment;
+            while (
+                (segment < path.size())
+                && (childCount > 0)
+            ) {
+                const auto rangeBegin = nodes.begin() + firstChild;
+                const auto rangeEnd = rangeBegin + childCount;
+                const auto child = std::lower_bound(
+                    rangeBegin,
+                    rangeEnd,
+                    path[segment],
+                    [](const RouteTableNode& node, const std::string& segment){
+                        return node.segment < segment;
+                    }
+                );
+                if (
+                    (child == rangeEnd)
+                    || (child->segment != path[segment])
+                ) {
+                    break;
+                }
+                handlers = &child->handlers;
+                firstChild = child->firstChild;
+                childCount = child->childCount;
+                ++segment;
+            }
+            segmentsMatched = segment;
+            return *handlers;
+        }
+    };
+
+    /**
+     * This function builds a flattened route table from the given
+     * resource tree.
+     *
+     * @param[in] resources
+     *      This is the resource tree from which to build the table.
+     *
+     * @return
+     *      The flattened route table is returned.
+     */
+    std::shared_ptr< RouteTable > BuildRouteTable(
+        std::shared_ptr< ResourceSpace > resources
+    ) {
+        const auto routeTable = std::make_shared< RouteTable >();
+        if (resources == nullptr) {
+            return routeTable;
+        }
+        routeTable->rootHandlers.handler = resources->handler;
+        routeTable->rootHandlers.streamingHandler = resources->streamingHandler;
+        routeTable->rootHandlers.asyncHandler = resources->asyncHandler;
+        // Emit the children of each space contiguously, breadth-first,
+        // relying on the subspace map already being ordered by segment.
+        std::deque< std::pair< std::shared_ptr< ResourceSpace >, size_t > > pending;
+        routeTable->rootFirstChild = 0;
+        routeTable->rootChildCount = resources->subspaces.size();
+        for (const auto& subspaceEntry: resources->subspaces) {
+            RouteTableNode node;
+            node.segment = subspaceEntry.first;
+            node.handlers.handler = subspaceEntry.second->handler;
+            node.handlers.streamingHandler = subspaceEntry.second->streamingHandler;
+            node.handlers.asyncHandler = subspaceEntry.second->asyncHandler;
+            pending.push_back({subspaceEntry.second, routeTable->nodes.size()});
+            routeTable->nodes.push_back(std::move(node));
+        }
+        while (!pending.empty()) {
+            const auto space = pending.front().first;
+            const auto nodeIndex = pending.front().second;
+            pending.pop_front();
+            routeTable->nodes[nodeIndex].firstChild = routeTable->nodes.size();
+            routeTable->nodes[nodeIndex].childCount = space->subspaces.size();
+            for (const auto& subspaceEntry: space->subspaces) {
+                RouteTableNode node;
+                node.segment = subspaceEntry.first;
+                node.handlers.handler = subspaceEntry.second->handler;
+                node.handlers.streamingHandler = subspaceEntry.second->streamingHandler;
+                node.handlers.asyncHandler = subspaceEntry.second->asyncHandler;
+                pending.push_back({subspaceEntry.second, routeTable->nodes.size()});
+                routeTable->nodes.push_back(std::move(node));
+            }
+        }
+        return routeTable;
+    }
+
+
+}
+
+namespace Http {
+
+    /**
+     * This contains the private properties of a Server instance
+     */
+
+    struct Server::Impl
+    {
+
+        // Properties
+
+        /**
+         * This is the pointer to the server who own the connection.
+         */
+        Server* server = nullptr;
+
+        /**
+         * this holds configuration items of the server.
+         */
+        std::map< std::string, std::string> configuration;
+
+        /**
+         * This is the typed snapshot of the configuration items the
+         * server consults while processing requests.  It's replaced as
+         * a whole (atomic shared_ptr swap) whenever a configuration
+         * item changes; readers pick it up at the start of each event
+         * and never see a partially-updated configuration.
+         */
+        std::shared_ptr< const ServerConfiguration > activeConfiguration = std::make_shared< ServerConfiguration >();
+
+        /**
+         * These are the transport layers currently bound, one per
+         * listener.  The first is the primary transport from the
+         * mobilization dependencies; the rest are the extra bindings.
+         */
+        std::vector< std::shared_ptr< ServerTransportLayer > > transports;
+
+        /**
+         * These are the shards of the connection table, one per
+         * listener, so that each listener's connections live on their
+         * own state.  The deque only ever grows, so that connections
+         * outliving a demobilization can still find their shard.
+         */
+        std::deque< ConnectionShard > connectionShards;
+
+        /**
+         * This is the head of the lock-free list of client connections
+         * that have been broken and will be destroyed by the reaper
+         * thread.  Producers push onto it with a compare-and-swap and
+         * never take a lock, so that a burst of disconnects doesn't
+         * contend with anything else the server is doing.
+         */
+        std::atomic< BrokenConnectionNode* > brokenConnections{nullptr};
+
+        /**
+         * This is a helper object used to generate and publish
+         * diagnostic messages.
+         */
+        SystemUtils::DiagnosticsSender diagnosticsSender;
+
+        /**
+         * This is a worker thread whose jobe is to drain the
+         * brokenConnections list. The reason we need to put broken
+         * connections there in the first place is because we can't
+         * destroy a connection that is in the process of calling
+         * us through one of the delegates we gave it.
+         */
+        std::thread reaper;
+
+        /**
+         * This represents the entire space of resources under the server.
+         */
+        std::shared_ptr< ResourceSpace > resources;
+
+        /**
+         * This is the flattened form of the resource tree used to route
+         * requests.  It's immutable once published: registration and
+         * unregistration build a whole new table and swap it in with an
+         * atomic store, so request threads read it wait-free, without
+         * any lock against registration changes.
+         */
+        std::shared_ptr< const RouteTable > routeTable = std::make_shared< RouteTable >();
+
+        /**
+         * This serializes changes to the resource tree from which the
+         * route table is built.  Request threads never take it; they
+         * only ever read published route table snapshots.
+         */
+        std::mutex registrationMutex;
+
+        /**
+         * This flag indicates whether or not the reaper thread should stop.
+         */
+        bool stopReaper = false;
+
+        /**
+         * This is the number of worker threads to mobilize for
+         * dispatching resource delegates.  If zero, requests are
+         * handled directly on the thread that received the data.
+         */
+        size_t workerThreadCount = DEFAULT_WORKER_THREADS;
+
+        /**
+         * These are the worker threads which take fully-assembled
+         * requests off the I/O path and run the registered resource
+         * delegates.
+         */
+        std::vector< std::thread > workers;
+
+        /**
+         * These are the connections which have assembled requests
+         * waiting to be handled by a worker thread.
+         */
+        std::deque< std::shared_ptr< ConnectionState > > connectionsReadyToProcess;
+
+        /**
+         * This is used to synchronize access to the queue of connections
+         * waiting to be serviced by the worker threads.
+         */
+        std::mutex workerMutex;
+
+        /**
+         * This is used by the worker threads to wait for connections
+         * to have requests ready to be handled.
+         */
+        std::condition_variable workerCondition;
+
+        /**
+         * This flag indicates whether or not the worker threads should stop.
+         */
+        bool stopWorkers = false;
+
+        /**
+         * This is the time keeper provided when the server was
+         * mobilized, used to measure connection timeouts.  If nullptr,
+         * timeouts are disabled.
+         */
+        std::shared_ptr< TimeKeeper > timeKeeper;
+
+        /**
+         * This is the timer wheel used to track connection timeouts.
+         * Each slot holds the connections whose deadlines fall within
+         * the span of time the slot covers, so that scheduling and
+         * firing timeouts are both O(1) per connection, rather than
+         * a per-connection timer or a sorted structure.  Deadlines are
+         * re-checked when a slot fires, so a connection whose deadline
+         * moved later is simply rescheduled.
+         */
+        std::vector< std::vector< std::weak_ptr< ConnectionState > > > timerWheel{TIMER_WHEEL_NUM_SLOTS};
+
+        /**
+         * This is the index of the timer wheel slot currently under
+         * the cursor.
+         */
+        size_t timerWheelCursor = 0;
+
+        /**
+         * This is the time, according to the time keeper, corresponding
+         * to the timer wheel slot currently under the cursor.
+         */
+        double timerWheelTime = 0.0;
+
+        /**
+         * This is used to synchronize access to the timer wheel.
+         */
+        std::mutex timerMutex;
+
+        /**
+         * This is used by the timer thread to wait between polls of
+         * the time keeper, and to be woken early when told to stop.
+         */
+        std::condition_variable timerCondition;
+
+        /**
+         * This flag indicates whether or not the timer thread should stop.
+         */
+        bool stopTimer = false;
+
+        /**
+         * This is the thread which advances the timer wheel and closes
+         * connections whose timeouts have expired.
+         */
+        std::thread timer;
+
+        /**
+         * This is the total number of responses the server has sent
+         * back to clients, including canned error responses.
+         */
+        std::atomic< size_t > requestsServed{0};
+
+        /**
+         * This is the total number of bytes the server has received
+         * from clients.
+         */
+        std::atomic< size_t > bytesReceived{0};
+
+        /**
+         * This is the total number of bytes the server has sent back
+         * to clients.
+         */
+        std::atomic< size_t > bytesSent{0};
+
+        /**
+         * This is the total number of requests which could not be
+         * parsed or were rejected as invalid.
+         */
+        std::atomic< size_t > parseErrors{0};
+
+        /**
+         * This is the number of bytes currently held across all
+         * connections' receive buffers and partially-assembled
+         * requests, charged and released through each connection's
+         * accountedBufferBytes, and checked against the aggregate
+         * buffer budget.
+         */
+        std::atomic< size_t > totalBufferedBytes{0};
+
+        /**
+         * This is a histogram of per-request service latencies.
+         * Bucket i counts requests whose latency was at most 2^i
+         * microseconds, with the last bucket collecting everything
+         * longer.  It's only populated when the server has a time
+         * keeper.
+         */
+        std::array< std::atomic< size_t >, LATENCY_BUCKET_COUNT > latencyBuckets{};
+
+        /**
+         * This is used only to put the reaper thread to sleep and wake
+         * it up again.  Producers take it just long enough to pair
+         * with the reaper's predicate check; they never hold it while
+         * doing any work, so it's effectively uncontended.
+         */
+        std::mutex reaperMutex;
+
+        /**
+         * This is used by the reaper thread to wait on any
+         * condition that it should cause it to wake up.
+         */
+        std::condition_variable condition;
+
+        /**
+         * This is the constructor for the structure
+         */
+        Impl(): diagnosticsSender("Http::Server"){
+
+        }
+
+        /**
+         * This method returns the configuration snapshot currently in
+         * effect.  Call it once at the start of an event and read
+         * fields from the returned snapshot, so that the whole event
+         * sees one consistent configuration.
+         *
+         * @return
+         *      The configuration snapshot currently in effect is
+         *      returned.
+         */
+        std::shared_ptr< const ServerConfiguration > GetActiveConfiguration() {
+            return std::atomic_load(&activeConfiguration);
+        }
+
+        /**
+         * This method publishes the given configuration as the new
+         * active snapshot.  Events already in progress finish with the
+         * snapshot they started with.
+         *
+         * @param[in] newConfiguration
+         *      This is the configuration to publish.
+         */
+        void PublishConfiguration(const ServerConfiguration& newConfiguration) {
+            std::atomic_store(
+                &activeConfiguration,
+                std::shared_ptr< const ServerConfiguration >(
+                    std::make_shared< ServerConfiguration >(newConfiguration)
+                )
+            );
+        }
+
+        /**
+         * This method returns the route table snapshot currently in
+         * effect.  Call it once per request and match against the
+         * returned snapshot, so that the whole request sees one
+         * consistent set of registrations even if a resource is
+         * registered or unregistered while the request is in flight.
+         *
+         * @return
+         *      The route table snapshot currently in effect is
+         *      returned.
+         */
+        std::shared_ptr< const RouteTable > GetActiveRouteTable() {
+            return std::atomic_load(&routeTable);
+        }
+
+        /**
+         * This method publishes the given route table as the new
+         * active snapshot.  Requests already being routed finish with
+         * the snapshot they started with.
+         *
+         * @param[in] newRouteTable
+         *      This is the route table to publish.
+         */
+        void PublishRouteTable(std::shared_ptr< const RouteTable > newRouteTable) {
+            std::atomic_store(&routeTable, newRouteTable);
+        }
+
+        /**
+         * This method hands the given connection over to the reaper
+         * thread to be destroyed.  It pushes a node onto the lock-free
+         * broken connections list and pokes the reaper awake; it takes
+         * no lock shared with connection servicing, so even a mass
+         * disconnect doesn't slow down the surviving connections.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection to hand
+         *      over to the reaper thread.
+         */
+        void QueueBrokenConnection(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            auto node = new BrokenConnectionNode;
+            node->connectionState = std::move(connectionState);
+            node->next = brokenConnections.load(std::memory_order_relaxed);
+            while (
+                !brokenConnections.compare_exchange_weak(
+                    node->next,
+                    node,
+                    std::memory_order_release,
+                    std::memory_order_relaxed
+                )
+            ) {
+            }
+            // The empty critical section pairs with the reaper's
+            // predicate check, so the notification can't slip in
+            // between the reaper finding the list empty and going
+            // to sleep.
+            {
+                std::lock_guard< decltype(reaperMutex) > lock(reaperMutex);
+            }
+            condition.notify_all();
+        }
+
+        /**
+         * This method takes the whole broken connections list in one
+         * atomic exchange, removes the connections from the set of
+         * established connections, and destroys them.  Only the reaper
+         * thread (and the destructor, after the reaper has stopped)
+         * calls this.
+         */
+        void ReapBrokenConnections() {
+            auto node = brokenConnections.exchange(
+                nullptr,
+                std::memory_order_acquire
+            );
+            if (node == nullptr) {
+                return;
+            }
+            for (auto link = node; link != nullptr; link = link->next) {
+                auto& shard = connectionShards[link->connectionState->shard];
+                std::lock_guard< decltype(shard.mutex) > lock(shard.mutex);
+                (void)shard.establishedConnections.erase(link->connectionState);
+            }
+            while (node != nullptr) {
+                const auto next = node->next;
+                {
+                    // Release the connection's charge against the
+                    // aggregate buffer budget exactly once.
+                    std::lock_guard< decltype(node->connectionState->mutex) > lock(node->connectionState->mutex);
+                    totalBufferedBytes.fetch_sub(
+                        node->connectionState->accountedBufferBytes,
+                        std::memory_order_relaxed
+                    );
+                    node->connectionState->accountedBufferBytes = 0;
+                }
+                delete node;
+                node = next;
+            }
+        }
+
+        /**
+         * This method is the body of the reaper thread.
+         * Until it's told to stop, it simply drains the lock-free
+         * broken connections list whenever it wakes up.  The reason we
+         * need to hand broken connections to a separate thread in the
+         * first place is because we can't destroy a connection that is
+         * in the process of calling us through one of the delegates we
+         * gave it.
+         */
+        void Reaper() {
+            std::unique_lock< decltype(reaperMutex) > lock(reaperMutex);
+            while (!stopReaper) {
+                lock.unlock();
+                ReapBrokenConnections();
+                lock.lock();
+                condition.wait(
+                    lock,
+                    [this]{
+                        return (
+                            stopReaper
+                            || (brokenConnections.load(std::memory_order_acquire) != nullptr)
+                        );
+                    }
+                );
+            }
+        }
+
+        /**
+         * This method places the given connection in the timer wheel
+         * slot corresponding to the given deadline.  The caller must
+         * hold the timer mutex.  Deadlines beyond the span of the wheel
+         * land in the furthest slot and are rescheduled when it fires.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection whose
+         *      timeout to schedule.
+         *
+         * @param[in] deadline
+         *      This is the time, according to the time keeper, at which
+         *      the timeout should fire.
+         */
+        void ScheduleTimeout(
+            std::shared_ptr< ConnectionState > connectionState,
+            double deadline
+        ) {
+            size_t ticks = 1;
+            if (deadline > timerWheelTime) {
+                ticks = (size_t)((deadline - timerWheelTime) / TIMER_WHEEL_SLOT_SECONDS) + 1;
+            }
+            ticks = std::min(ticks, TIMER_WHEEL_NUM_SLOTS - 1);
+            timerWheel[(timerWheelCursor + ticks) % TIMER_WHEEL_NUM_SLOTS].push_back(connectionState);
+        }
+
+        /**
+         * This method closes the given connection because one of its
+         * timeouts expired, handing it over to the reaper thread,
+         * since the peer is presumed gone and won't break the
+         * connection itself.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection to close.
+         */
+        void TimeoutConnection(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            {
+                auto& shard = connectionShards[connectionState->shard];
+                std::lock_guard< decltype(shard.mutex) > lock(shard.mutex);
+                if (shard.establishedConnections.find(connectionState) == shard.establishedConnections.end()) {
+                    // The connection is already on its way to the reaper.
+                    return;
+                }
+            }
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                2,
+                "Connection to %s timed out, closing",
+                connectionState->connection->GetPeerId().c_str()
+            );
+            QueueBrokenConnection(connectionState);
+            connectionState->connection->Break(false);
+        }
+
+        /**
+         * This method is the body of the timer thread.
+         * Until it's told to stop, it polls the time keeper, advances
+         * the timer wheel past any slots whose time has come, and
+         * closes connections whose deadlines have expired, rescheduling
+         * those whose deadlines moved later due to activity.
+         */
+        void Timer() {
+            std::unique_lock< decltype(timerMutex) > lock(timerMutex);
+            timerWheelTime = timeKeeper->GetCurrentTime();
+            while (!stopTimer) {
+                (void)timerCondition.wait_for(
+                    lock,
+                    std::chrono::milliseconds(TIMER_POLL_MILLISECONDS),
+                    [this]{ return stopTimer; }
+                );
+                if (stopTimer) {
+                    break;
+                }
+                const auto now = timeKeeper->GetCurrentTime();
+                const auto config = GetActiveConfiguration();
+                std::vector< std::shared_ptr< ConnectionState > > expiredConnections;
+                while (timerWheelTime + TIMER_WHEEL_SLOT_SECONDS <= now) {
+                    timerWheelTime += TIMER_WHEEL_SLOT_SECONDS;
+                    timerWheelCursor = (timerWheelCursor + 1) % TIMER_WHEEL_NUM_SLOTS;
+                    auto slotEntries = std::move(timerWheel[timerWheelCursor]);
+                    timerWheel[timerWheelCursor].clear();
+                    for (auto& slotEntry: slotEntries) {
+                        const auto connectionState = slotEntry.lock();
+                        if (connectionState == nullptr) {
+                            continue;
+                        }
+                        double deadline;
+                        {
+                            std::lock_guard< decltype(connectionState->mutex) > connectionLock(connectionState->mutex);
+                            deadline = connectionState->lastActivityTime + config->inactivityTimeout;
+                            if (connectionState->requestStartTime != 0.0) {
+                                deadline = std::min(
+                                    deadline,
+                                    connectionState->requestStartTime + config->requestTimeout
+                                );
+                            }
+                        }
+                        if (deadline <= now) {
+                            expiredConnections.push_back(connectionState);
+                        } else {
+                            ScheduleTimeout(connectionState, deadline);
+                        }
+                    }
+                }
+                if (!expiredConnections.empty()) {
+                    lock.unlock();
+                    for (const auto& connectionState: expiredConnections) {
+                        TimeoutConnection(connectionState);
+                    }
+                    lock.lock();
+                }
+            }
+        }
+
+           /**
+         * This method appends the given data to the end of the concatenate
+         * buffer, and then attempts to parse a request out of it.
+         * 
+         * @param[in] server
+         *      This is the server that has this connection.
+         * 
+         * @return 
+         *      The request parsed from the concatenate buffer is returned.
+         * 
+         * @retval nullptr
+         *      This is returned if no request could be parsed from the 
+         *      concatinate buffer
+         */
+        std::shared_ptr< Request > TryRequestAssembly(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            const auto messageEnd =  ParseRequest(
+                connectionState->nextRequest,
+                connectionState->receiveBuffer.data,
+                connectionState->receiveBuffer.consumed,
+                true
+            );
+            connectionState->receiveBuffer.Consume(
+                messageEnd - connectionState->receiveBuffer.consumed
+            );
             if (!connectionState->nextRequest->IsProcessed()) {
                 return nullptr;
             }
             const auto request = connectionState->nextRequest;
-            connectionState->nextRequest = std::make_shared< Request >();
-            return request;
+            connectionState->nextRequest = connectionState->FetchRequest();
+            return request;
+        }
+        
+        /**
+         * This method is called one or more times to incrementally parses the given string as a raw Http request message.
+         * If the string parses correctly, the equivalent Request is returned.
+         * otherwise, nullptr is returned.
+         * 
+         * @param[in, out] request
+         *      This is the request to parse.
+         * 
+         * @param[in] nextRawRequestPart
+         *      This is the raw HTTP request message as a string.
+         *
+         * @param[in] offset
+         *      This is the offset into the given string of the first
+         *      character not yet consumed by a previous parse attempt.
+         *
+         * @param[in] stopAfterHeaders
+         *      If set, parsing stops as soon as the headers are complete,
+         *      before any of the body is examined, so that the caller can
+         *      decide whether the body should be buffered or streamed.
+         *
+         * @return
+         *      The index just past the last character that was taken from
+         *      the given input string is returned. Presumably,
+         *      any charachters past this point belong to another message or
+         *      are outside the scope of HTTP.
+         */
+        size_t ParseRequest(
+            std::shared_ptr< Request > request,
+            const std::string& nextRawRequestPart,
+            size_t offset = 0,
+            bool stopAfterHeaders = false
+        ) {
+            const auto config = GetActiveConfiguration();
+            // Index just past the last character incorporated into
+            // the request object.
+            size_t messageEnd = offset;
+            if (request->state == Request::RequestParsingState::RequestLine) {
+                // First, extarct the request line.
+                const auto requestLineEnd = FindCRLF(nextRawRequestPart, offset);
+                if (requestLineEnd == std::string::npos) {
+                    if (nextRawRequestPart.length() - offset > config->headerLineLimit) {
+                        request->state = Request::RequestParsingState::Error;
+                        return messageEnd;
+                    }
+                    return messageEnd;
+                }
+                const auto requestLineLength = requestLineEnd - offset;
+                if (requestLineLength > config->headerLineLimit) {
+                    request->state = Request::RequestParsingState::Error;
+                    return messageEnd;
+                }
+                messageEnd = requestLineEnd + CRLF.length();
+                request->state = Request::RequestParsingState::Headers;
+                request->valid = ParseRequestLine(request, nextRawRequestPart, offset, requestLineEnd);
+            }
+            //Second, parse the message headers and identify where the body begins.
+            
+            if (request->state == Request::RequestParsingState::Headers) {
+                // Accumulate the new characters onto the request's raw
+                // header block, and scan only the characters not scanned
+                // before for the end of the headers, so that headers
+                // which trickle in over many packets aren't re-copied and
+                // re-scanned on every arrival.
+                const auto priorHeadersLength = request->rawHeaders.length();
+                request->rawHeaders.append(
+                    nextRawRequestPart,
+                    messageEnd,
+                    std::string::npos
+                );
+                auto searchStart = request->headersLineStart;
+                if (priorHeadersLength > searchStart + 1) {
+                    // Back up one character in case a CRLF straddles
+                    // the boundary between two arrivals.
+                    searchStart = priorHeadersLength - 1;
+                }
+                size_t headersEnd = std::string::npos;
+                for (;;) {
+                    const auto lineEnd = FindCRLF(request->rawHeaders, searchStart);
+                    if (lineEnd == std::string::npos) {
+                        if (
+                            request->rawHeaders.length() - request->headersLineStart
+                            > config->headerLineLimit
+                        ) {
+                            request->state = Request::RequestParsingState::Error;
+                        }
+                        return nextRawRequestPart.length();
+                    }
+                    if (lineEnd == request->headersLineStart) {
+                        // An empty line marks the end of the headers.
+                        headersEnd = lineEnd + CRLF.length();
+                        break;
+                    }
+                    if (
+                        lineEnd + CRLF.length() - request->headersLineStart
+                        > config->headerLineLimit
+                    ) {
+                        request->state = Request::RequestParsingState::Error;
+                        return nextRawRequestPart.length();
+                    }
+                    request->headersLineStart = lineEnd + CRLF.length();
+                    searchStart = request->headersLineStart;
+                }
+                // Give back any characters received beyond the end of the
+                // headers; they belong to the body or to the next request.
+                messageEnd = (
+                    nextRawRequestPart.length()
+                    - (request->rawHeaders.length() - headersEnd)
+                );
+                request->rawHeaders.resize(headersEnd);
+                request->headers.SetLineLimit(config->headerLineLimit);
+                size_t bodyOffset = 0;
+                if (
+                    request->headers.ParseRawMessage(
+                        request->rawHeaders,
+                        bodyOffset
+                    ) != MessageHeaders::MessageHeaders::State::Complete
+                ) {
+                    request->state = Request::RequestParsingState::Error;
+                    return messageEnd;
+                }
+                // Done with parsing headers; next will be the body.
+                if (!request->headers.IsValid()) {
+                    request->valid = false;
+                }
+                request->state = Request::RequestParsingState::Body;
+                // Cache the hot header values on the request, so that
+                // the rest of the pipeline reads plain fields rather
+                // than re-searching the header list per use.
+                request->hasHost = request->headers.HasHeader("Host");
+                if (request->hasHost) {
+                    request->host = request->headers.GetHeaderValue("Host");
+                }
+                request->hasContentLength = request->headers.HasHeader("Content-Length");
+                if (request->hasContentLength) {
+                    switch (ParseSize(request->headers.GetHeaderValue("Content-Length"), request->contentLength)) {
+
+                        case ParseSizeResult::NotaNumber:
+                        {
+                            request->state = Request::RequestParsingState::Error;
+                            return messageEnd;
+                        }
+                        case ParseSizeResult::Overflow:
+                        {
+                            request->state = Request::RequestParsingState::Error;
+                            request->responseStatusCode = 413;
+                            request->responseStatusPhrase = "Payload Too Large";
+                            return messageEnd;
+                        }
+
+                    }
+                }
+                for (const auto& connectionTocken: request->headers.GetHeaderMultiValues("Connection")) {
+                    if (connectionTocken == "close") {
+                        request->closeRequested = true;
+                        break;
+                    }
+                }
+                // Check the "Host" header
+                if (request->hasHost) {
+                    const auto& requestHost = request->host;
+                    auto serverHost = config->host;
+                    if (serverHost.empty()) {
+                        serverHost = requestHost;
+                    }
+                    auto targetHost = request->target.GetHost();
+                    if (targetHost.empty()) {
+                        targetHost = serverHost;
+                    }
+                    if ((requestHost != targetHost) || (requestHost != serverHost)) {
+                        request->valid = false;
+                    }
+                    // TODO: check that target host matches server host.
+                } else {
+                    request->valid = false;
+                }
+                if (stopAfterHeaders) {
+                    return messageEnd;
+                }
+            }
+
+            // Finally, extract the body.
+            if (request->state == Request::RequestParsingState::Body) {
+                // Check for "Content-Length" header, if present, use it to
+                // determine how many characters should be in the body.
+                const auto bodyAvailableSize = nextRawRequestPart.length() - messageEnd;
+                // If it containt "Content-Length" header, we carefully carve exactly
+                // that number of cahracters out (and bail if we don't have anough)
+                if (request->hasContentLength) {
+                    const auto contentLength = request->contentLength;
+                    if (contentLength > MAX_CONTENT_LENGTH) {
+                        request->state = Request::RequestParsingState::Error;
+                        request->responseStatusCode = 413;
+                        request->responseStatusPhrase = "Payload Too Large";
+                        return messageEnd;
+                    }
+                    if (contentLength > bodyAvailableSize) {
+                        request->state = Request::RequestParsingState::Body;
+                        return messageEnd;
+                    } else {
+                        request->body = nextRawRequestPart.substr(messageEnd, contentLength);
+                        messageEnd += contentLength;
+                        request->state = Request::RequestParsingState::Complete;
+                    }
+                } else {
+                    //Finally, extract the body
+                    request->body.clear();
+                    request->state = Request::RequestParsingState::Complete;
+                }
+            }
+            return messageEnd;
+        }
+
+        /**
+         * This method brings the given connection's charge against the
+         * server's aggregate buffer budget up to date with the number
+         * of bytes the connection is actually holding, in its receive
+         * buffer and in the request currently being assembled.  The
+         * caller must hold the connection's mutex.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection whose
+         *      charge to bring up to date.
+         *
+         * @return
+         *      The new aggregate number of buffered bytes across all
+         *      connections is returned.
+         */
+        size_t ReconcileBufferAccounting(
+            const std::shared_ptr< ConnectionState >& connectionState
+        ) {
+            size_t buffered = connectionState->receiveBuffer.Available();
+            if (connectionState->nextRequest != nullptr) {
+                buffered += connectionState->nextRequest->rawHeaders.length();
+                buffered += connectionState->nextRequest->body.length();
+            }
+            const auto previouslyAccounted = connectionState->accountedBufferBytes;
+            connectionState->accountedBufferBytes = buffered;
+            if (buffered >= previouslyAccounted) {
+                const auto delta = buffered - previouslyAccounted;
+                return totalBufferedBytes.fetch_add(delta, std::memory_order_relaxed) + delta;
+            } else {
+                const auto delta = previouslyAccounted - buffered;
+                return totalBufferedBytes.fetch_sub(delta, std::memory_order_relaxed) - delta;
+            }
+        }
+
+        /**
+         * This method is called when new data is received from a connection
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection from which
+         *      data was received.
+         *
+         * @param[in] data
+         *      This is the data that was received from the connection.
+         *      Ownership of the buffer is transferred to this method.
+         */
+        void DataReceived(
+            std::shared_ptr< ConnectionState > connectionState,
+            std::vector< uint8_t >&& data
+        ) {
+            bytesReceived.fetch_add(data.size(), std::memory_order_relaxed);
+            if (timeKeeper != nullptr) {
+                const auto now = timeKeeper->GetCurrentTime();
+                connectionState->lastActivityTime = now;
+                if (connectionState->requestStartTime == 0.0) {
+                    connectionState->requestStartTime = now;
+                }
+            }
+            connectionState->receiveBuffer.Append(data);
+            const auto config = GetActiveConfiguration();
+            const auto totalBuffered = ReconcileBufferAccounting(connectionState);
+            if (
+                (connectionState->accountedBufferBytes > config->connectionBufferLimit)
+                || (
+                    (config->totalBufferLimit != 0)
+                    && (totalBuffered > config->totalBufferLimit)
+                )
+            ) {
+                // The connection is over its buffer budget (or the
+                // server as a whole is); reject the request
+                // immediately rather than letting the buffers keep
+                // growing.  If the header section is still being
+                // received, the headers themselves are what's too
+                // large; otherwise it's the body.
+                parseErrors.fetch_add(1, std::memory_order_relaxed);
+                const unsigned int statusCode = (
+                    (connectionState->streamingRequest == nullptr)
+                    && (connectionState->nextRequest->state != Request::RequestParsingState::Body)
+                ) ? 431 : 413;
+                SendCannedResponse(connectionState, statusCode);
+                CloseAfterOutput(connectionState);
+                return;
+            }
+            for (;;) {
+                if (connectionState->streamingRequest != nullptr) {
+                    if (!DeliverRequestBody(connectionState)) {
+                        break;
+                    }
+                    continue;
+                }
+                auto request = TryRequestAssembly(connectionState);
+                if (request == nullptr) {
+                    if (
+                        (connectionState->nextRequest->state == Request::RequestParsingState::Body)
+                        && !connectionState->bodyStreamingDecided
+                    ) {
+                        // The headers of the next request just completed;
+                        // decide whether its body should be streamed to
+                        // its handler or buffered as usual.
+                        connectionState->bodyStreamingDecided = true;
+                        if (!HandleRequestExpectation(connectionState)) {
+                            return;
+                        }
+                        TryBeginBodyStreaming(connectionState);
+                        continue;
+                    }
+                    break;
+                }
+                connectionState->bodyStreamingDecided = false;
+                const auto requestState = request->state;
+                if (workers.empty()) {
+                    ProcessRequest(connectionState, request);
+                    connectionState->RecycleRequest(std::move(request));
+                } else {
+                    DispatchRequest(connectionState, std::move(request));
+                }
+                if (requestState != Request::RequestParsingState::Complete) {
+                    break;
+                }
+            }
+            FlushOutput(connectionState);
+            (void)ReconcileBufferAccounting(connectionState);
+            if (
+                !connectionState->receivePaused
+                && !connectionState->requestsReady.empty()
+                && (connectionState->accountedBufferBytes > config->connectionBufferLimit / 2)
+            ) {
+                // Requests are piling up faster than the worker
+                // threads drain them; stop accepting more data on
+                // this connection until its responses have gone out.
+                connectionState->receivePaused = true;
+                connectionState->connection->SetReceivePaused(true);
+            }
+            if (timeKeeper != nullptr) {
+                // The request timeout covers the receipt of a header
+                // section; once the headers are done (or nothing is in
+                // progress), only the inactivity timeout applies.
+                const auto state = connectionState->nextRequest->state;
+                if (
+                    (connectionState->streamingRequest != nullptr)
+                    || (state == Request::RequestParsingState::Body)
+                    || (
+                        (state == Request::RequestParsingState::RequestLine)
+                        && (connectionState->receiveBuffer.Available() == 0)
+                    )
+                ) {
+                    connectionState->requestStartTime = 0.0;
+                }
+            }
+        }
+
+        /**
+         * This method sends any response segments held back on the
+         * given connection out through a single gather write.  It must
+         * be called before any direct send or break of the connection,
+         * so that responses go out in order.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection whose
+         *      held-back output to send.
+         */
+        void FlushOutput(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            if (connectionState->outputSegments.empty()) {
+                return;
+            }
+            auto outputSegments = std::move(connectionState->outputSegments);
+            connectionState->outputSegments.clear();
+            connectionState->connection->SendData(std::move(outputSegments));
+        }
+
+        /**
+         * This method finishes the given connection's service with a
+         * graceful break, flushing any queued output first.  If
+         * responses are parked awaiting an asynchronous handler, the
+         * break is deferred until the last parked response has been
+         * sent, so that no queued response is ever dropped.  The
+         * caller must hold the connection's mutex.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection to
+         *      close.
+         */
+        void CloseAfterOutput(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            if (!connectionState->pendingResponses.empty()) {
+                connectionState->pendingResponses.back()->closeAfter = true;
+                return;
+            }
+            FlushOutput(connectionState);
+            connectionState->connection->Break(true);
+        }
+
+        /**
+         * This method serializes the status line and headers of the
+         * given response, written directly into the given connection's
+         * serialization buffer with plain appends rather than through
+         * iostreams or printf-style formatting, and queues them as a
+         * single output segment.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection through
+         *      which the response will be sent.
+         *
+         * @param[in] response
+         *      This is the response whose status line and headers to
+         *      serialize.
+         *
+         * @return
+         *      The number of bytes queued is returned.
+         */
+        size_t SerializeResponseHead(
+            const std::shared_ptr< ConnectionState >& connectionState,
+            const std::shared_ptr< Client::Response >& response
+        ) {
+            const auto rawHeaders = response->headers.GenerateRawHeaders();
+            auto& head = connectionState->serializationBuffer;
+            head.clear();
+            head.reserve(
+                15
+                + response->status.length()
+                + rawHeaders.length()
+            );
+            head += "HTTP/1.1 ";
+            AppendDecimal(response->statusCode, head);
+            head += ' ';
+            head += response->status;
+            head += CRLF;
+            head += rawHeaders;
+            // The head is copied out into its gather-write segment so
+            // that the buffer, and the capacity it has grown, stay
+            // with the connection for its next response.
+            connectionState->outputSegments.push_back(head);
+            return head.length();
+        }
+
+        /**
+         * This method serializes the given response and queues it to be
+         * sent back through the given connection, adding a
+         * "Content-Length" header if one is needed, and handing the
+         * serialized head and the body over as separate segments so no
+         * intermediate copy of the full response is made.  The segments
+         * are held back so that all the responses produced by one
+         * data-arrival event go out in a single gather write when the
+         * output is flushed.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection through
+         *      which to send the response.
+         *
+         * @param[in] response
+         *      This is the response to send.
+         */
+        void SendResponse(
+            std::shared_ptr< ConnectionState > connectionState,
+            std::shared_ptr< Client::Response > response
+        ) {
+            if (
+                !connectionState->pendingResponses.empty()
+                && !connectionState->sendingParkedResponse
+            ) {
+                // An earlier request on this connection is still
+                // waiting for its asynchronous handler; park this
+                // response behind it, so that responses go back in
+                // the order the requests came in.
+                const auto slot = std::make_shared< PendingResponse >();
+                slot->ready = true;
+                slot->response = response;
+                connectionState->pendingResponses.push_back(slot);
+                return;
+            }
+            if (response->bodyProducer != nullptr) {
+                // The handler supplied a body producer rather than a
+                // body; stream the body out with chunked
+                // transfer-encoding, one produced piece at a time, so
+                // that the whole body never exists in memory at once.
+                response->headers.SetHeader("Transfer-Encoding", "chunked");
+                bytesSent.fetch_add(
+                    SerializeResponseHead(connectionState, response),
+                    std::memory_order_relaxed
+                );
+                FlushOutput(connectionState);
+                for (;;) {
+                    auto piece = response->bodyProducer();
+                    if (piece.empty()) {
+                        break;
+                    }
+                    Connection::DataSegments chunkSegments;
+                    chunkSegments.push_back(
+                        StringUtils::sprintf("%zx\r\n", piece.length())
+                    );
+                    chunkSegments.push_back(std::move(piece));
+                    chunkSegments.push_back(CRLF);
+                    size_t chunkSize = 0;
+                    for (const auto& chunkSegment: chunkSegments) {
+                        chunkSize += chunkSegment.length();
+                    }
+                    bytesSent.fetch_add(chunkSize, std::memory_order_relaxed);
+                    connectionState->connection->SendData(std::move(chunkSegments));
+                }
+                Connection::DataSegments lastChunkSegments;
+                lastChunkSegments.push_back("0\r\n\r\n");
+                bytesSent.fetch_add(lastChunkSegments.back().length(), std::memory_order_relaxed);
+                connectionState->connection->SendData(std::move(lastChunkSegments));
+                requestsServed.fetch_add(1, std::memory_order_relaxed);
+                diagnosticsSender.SendDiagnosticInformationFormatted(
+                    1,
+                    "Sent %u '%s' response back to %s",
+                    response->statusCode,
+                    response->status.c_str(),
+                    connectionState->connection->GetPeerId().c_str()
+                );
+                return;
+            }
+            if (!response->bodyFilePath.empty()) {
+                // The body is a region of a file; send the headers,
+                // then hand the region to the connection's
+                // file-sending capability, reading it ourselves only
+                // if the connection doesn't have one.
+                response->headers.SetHeader(
+                    "Content-Length",
+                    StringUtils::sprintf("%zu", response->bodyFileLength)
+                );
+                bytesSent.fetch_add(
+                    SerializeResponseHead(connectionState, response),
+                    std::memory_order_relaxed
+                );
+                FlushOutput(connectionState);
+                if (
+                    !connectionState->connection->SendFileRegion(
+                        response->bodyFilePath,
+                        response->bodyFileOffset,
+                        response->bodyFileLength
+                    )
+                ) {
+                    std::ifstream file(response->bodyFilePath, std::ios::binary);
+                    std::string bodyData(response->bodyFileLength, '\0');
+                    file.seekg((std::streamoff)response->bodyFileOffset);
+                    file.read(&bodyData[0], (std::streamsize)response->bodyFileLength);
+                    if (
+                        !file
+                        || ((size_t)file.gcount() != response->bodyFileLength)
+                    ) {
+                        // The file couldn't deliver the promised bytes
+                        // -- deleted or truncated since it was examined
+                        // -- and the framing has already been
+                        // committed, so the only honest recovery is to
+                        // drop the connection rather than pad out the
+                        // body.
+                        diagnosticsSender.SendDiagnosticInformationFormatted(
+                            3,
+                            "Unable to read %zu bytes from '%s'; dropping connection to %s",
+                            response->bodyFileLength,
+                            response->bodyFilePath.c_str(),
+                            connectionState->connection->GetPeerId().c_str()
+                        );
+                        connectionState->connection->Break(false);
+                        return;
+                    }
+                    Connection::DataSegments bodySegments;
+                    bodySegments.push_back(std::move(bodyData));
+                    connectionState->connection->SendData(std::move(bodySegments));
+                }
+                bytesSent.fetch_add(response->bodyFileLength, std::memory_order_relaxed);
+                requestsServed.fetch_add(1, std::memory_order_relaxed);
+                diagnosticsSender.SendDiagnosticInformationFormatted(
+                    1,
+                    "Sent %u '%s' response back to %s",
+                    response->statusCode,
+                    response->status.c_str(),
+                    connectionState->connection->GetPeerId().c_str()
+                );
+                return;
+            }
+            if(
+                !response->headers.HasHeader("Transfer-Encoding")
+                && !response->body.empty()
+                && !response->headers.HasHeader("Content-Length")
+            ) {
+                response->headers.AddHeader(
+                    "Content-Length",
+                    StringUtils::sprintf("%zu", response->body.length())
+                );
+            }
+            auto responseSize = SerializeResponseHead(connectionState, response);
+            responseSize += response->body.length();
+            connectionState->outputSegments.push_back(std::move(response->body));
+            bytesSent.fetch_add(responseSize, std::memory_order_relaxed);
+            requestsServed.fetch_add(1, std::memory_order_relaxed);
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                1,
+                "Sent %u '%s' response back to %s",
+                response->statusCode,
+                response->status.c_str(),
+                connectionState->connection->GetPeerId().c_str()
+            );
+        }
+
+        /**
+         * This method queues the pre-serialized canned response for the
+         * given status code to be sent back through the given
+         * connection when the output is next flushed.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection through
+         *      which to send the response.
+         *
+         * @param[in] statusCode
+         *      This is the status code of the canned response to send.
+         */
+        void SendCannedResponse(
+            std::shared_ptr< ConnectionState > connectionState,
+            unsigned int statusCode
+        ) {
+            if (
+                !connectionState->pendingResponses.empty()
+                && !connectionState->sendingParkedResponse
+            ) {
+                // An earlier request on this connection is still
+                // waiting for its asynchronous handler; park this
+                // response behind it, so that responses go back in
+                // the order the requests came in.
+                const auto slot = std::make_shared< PendingResponse >();
+                slot->ready = true;
+                slot->cannedStatusCode = statusCode;
+                connectionState->pendingResponses.push_back(slot);
+                return;
+            }
+            const auto& cannedResponse = GetCannedResponse(statusCode);
+            bytesSent.fetch_add(cannedResponse.data.length(), std::memory_order_relaxed);
+            connectionState->outputSegments.push_back(cannedResponse.data);
+            requestsServed.fetch_add(1, std::memory_order_relaxed);
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                1,
+                "Sent %u '%s' response back to %s",
+                cannedResponse.statusCode,
+                cannedResponse.status.c_str(),
+                connectionState->connection->GetPeerId().c_str()
+            );
+        }
+
+        /**
+         * This method sends out the parked responses at the front of
+         * the given connection's pending queue which are ready,
+         * stopping at the first one whose asynchronous handler hasn't
+         * completed yet, so that responses go back in the order the
+         * requests came in.  The caller must hold the connection's
+         * mutex.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection whose
+         *      parked responses to send.
+         */
+        void DrainPendingResponses(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            while (
+                !connectionState->pendingResponses.empty()
+                && connectionState->pendingResponses.front()->ready
+            ) {
+                const auto slot = connectionState->pendingResponses.front();
+                connectionState->pendingResponses.pop_front();
+                connectionState->sendingParkedResponse = true;
+                if (slot->response != nullptr) {
+                    SendResponse(connectionState, slot->response);
+                } else if (slot->cannedStatusCode != 0) {
+                    SendCannedResponse(connectionState, slot->cannedStatusCode);
+                } else {
+                    // The asynchronous handler completed without
+                    // producing a response.
+                    SendCannedResponse(connectionState, 500);
+                }
+                connectionState->sendingParkedResponse = false;
+                if (slot->closeAfter) {
+                    FlushOutput(connectionState);
+                    connectionState->connection->Break(true);
+                }
+            }
+        }
+
+        /**
+         * This method adds the given per-request service latency to the
+         * latency histogram.
+         *
+         * @param[in] seconds
+         *      This is the service latency of the request, in seconds.
+         */
+        void RecordServiceLatency(double seconds) {
+            double bucketUpperBound = 1e-6;
+            size_t bucket = 0;
+            while (
+                (bucket < LATENCY_BUCKET_COUNT - 1)
+                && (seconds > bucketUpperBound)
+            ) {
+                bucketUpperBound *= 2.0;
+                ++bucket;
+            }
+            latencyBuckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /**
+         * This method handles any "Expect" header on a request whose
+         * header section just completed, before any of its body has
+         * been accepted.  A request expecting "100-continue" gets an
+         * answer right away, decided from the request line, headers,
+         * routing, and declared content length alone: either an
+         * interim 100 Continue response telling the client to go
+         * ahead with the body, or a final error response, so that a
+         * body the server would only reject never crosses the network
+         * at all.  The caller must hold the connection's mutex.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection from
+         *      which the request was received.
+         *
+         * @return
+         *      An indication of whether or not the connection may
+         *      continue to be used is returned.  If false, a final
+         *      error response has been sent and the connection is
+         *      being closed.
+         */
+        bool HandleRequestExpectation(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            const auto request = connectionState->nextRequest;
+            bool expectContinue = false;
+            for (const auto& expectation: request->headers.GetHeaderMultiValues("Expect")) {
+                if (expectation == "100-continue") {
+                    expectContinue = true;
+                    break;
+                }
+            }
+            if (!expectContinue) {
+                return true;
+            }
+            unsigned int statusCode = 0;
+            if (!request->valid) {
+                statusCode = 400;
+            } else if (
+                request->hasContentLength
+                && (request->contentLength > MAX_CONTENT_LENGTH)
+            ) {
+                statusCode = 413;
+            } else {
+                const auto routeTable = GetActiveRouteTable();
+                const auto originalResourcePath = request->target.GetPath();
+                size_t firstSegment = 0;
+                if (
+                    !originalResourcePath.empty()
+                    && (originalResourcePath.front() == "")
+                ) {
+                    ++firstSegment;
+                }
+                size_t segmentsMatched = firstSegment;
+                const auto& handlers = routeTable->Match(
+                    originalResourcePath,
+                    firstSegment,
+                    segmentsMatched
+                );
+                if (
+                    (handlers.handler == nullptr)
+                    && (handlers.streamingHandler == nullptr)
+                    && (handlers.asyncHandler == nullptr)
+                ) {
+                    statusCode = 404;
+                }
+            }
+            if (statusCode != 0) {
+                if (statusCode != 404) {
+                    parseErrors.fetch_add(1, std::memory_order_relaxed);
+                }
+                SendCannedResponse(connectionState, statusCode);
+                CloseAfterOutput(connectionState);
+                return false;
+            }
+            bytesSent.fetch_add(CONTINUE_RESPONSE.length(), std::memory_order_relaxed);
+            connectionState->outputSegments.push_back(CONTINUE_RESPONSE);
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                1,
+                "Sent %u '%s' response back to %s",
+                100,
+                "Continue",
+                connectionState->connection->GetPeerId().c_str()
+            );
+            return true;
         }
-        
+
         /**
-         * This method is called one or more times to incrementally parses the given string as a raw Http request message.
-         * If the string parses correctly, the equivalent Request is returned.
-         * otherwise, nullptr is returned.
-         * 
-         * @param[in, out] request
-         *      This is the request to parse.
-         * 
-         * @param[in] nextRawRequestPart
-         *      This is the raw HTTP request message as a string.
-         * 
-         * @param[out] messageEnd
-         *      This is the raw HTTP request message as a single string.
-         * 
+         * This method is called once the headers of the request currently
+         * being received on the given connection are complete, to decide
+         * whether its body should be streamed to a registered streaming
+         * handler.  If so, the handler is called to obtain the body
+         * delegate and the connection is switched into streaming mode;
+         * otherwise the request takes the usual buffered path.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection on which
+         *      the request is being received.
+         */
+        void TryBeginBodyStreaming(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            const auto request = connectionState->nextRequest;
+            if (!request->valid) {
+                return;
+            }
+            const auto routeTable = GetActiveRouteTable();
+            const auto originalResourcePath = request->target.GetPath();
+            size_t firstSegment = 0;
+            if (
+                !originalResourcePath.empty()
+                && (originalResourcePath.front() == "")
+            ) {
+                ++firstSegment;
+            }
+            size_t segmentsMatched = firstSegment;
+            const auto& handlers = routeTable->Match(
+                originalResourcePath,
+                firstSegment,
+                segmentsMatched
+            );
+            if (handlers.streamingHandler == nullptr) {
+                return;
+            }
+            // Determine the framing of the body.  The content length
+            // was already decoded and cached when the headers
+            // completed.
+            bool chunked = false;
+            for (const auto& encoding: request->headers.GetHeaderMultiValues("Transfer-Encoding")) {
+                if (encoding == "chunked") {
+                    chunked = true;
+                }
+            }
+            size_t contentLength = 0;
+            if (
+                !chunked
+                && request->hasContentLength
+            ) {
+                contentLength = request->contentLength;
+            }
+            const auto targetString = request->target.GenerateString();
+            request->target.SetPath(
+                std::vector< std::string >(
+                    originalResourcePath.begin() + segmentsMatched,
+                    originalResourcePath.end()
+                )
+            );
+            auto bodyDelegate = handlers.streamingHandler(request);
+            if (bodyDelegate == nullptr) {
+                // The handler declined to stream this request's body;
+                // put the original target path back, so that the
+                // request routes normally once its body has been
+                // buffered.
+                request->target.SetPath(originalResourcePath);
+                return;
+            }
+            diagnosticsSender.SendDiagnosticInformationFormatted(
+                1,
+                "Received %s request for '%s' from %s",
+                request->method.c_str(),
+                targetString.c_str(),
+                connectionState->connection->GetPeerId().c_str()
+            );
+            connectionState->bodyDelegate = std::move(bodyDelegate);
+            connectionState->streamingRequest = request;
+            connectionState->nextRequest = connectionState->FetchRequest();
+            connectionState->chunkedBody = chunked;
+            connectionState->chunkState = ChunkDecodeState::Size;
+            connectionState->bodyBytesRemaining = contentLength;
+        }
+
+        /**
+         * This method ends the streaming of a request body on the given
+         * connection, sending back the canned response for the given
+         * status code and breaking the connection.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection on which
+         *      the body was being streamed.
+         *
+         * @param[in] statusCode
+         *      This is the status code of the canned response to send.
+         */
+        void AbortBodyStreaming(
+            std::shared_ptr< ConnectionState > connectionState,
+            unsigned int statusCode
+        ) {
+            connectionState->streamingRequest = nullptr;
+            connectionState->bodyDelegate = nullptr;
+            parseErrors.fetch_add(1, std::memory_order_relaxed);
+            SendCannedResponse(connectionState, statusCode);
+            CloseAfterOutput(connectionState);
+        }
+
+        /**
+         * This method completes the streaming of a request body on the
+         * given connection: the body delegate is told the last piece has
+         * arrived, and the response it produces is sent back.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection on which
+         *      the body was being streamed.
+         *
          * @return
-         *      A count of the number of charachters that were taken from
-         *      the given input string is treturned. Presumably,
-         *      any charachters past this point belong to another message or
-         *      are outside the scope of HTTP. 
+         *      An indication of whether or not the connection may carry
+         *      another request is returned.
          */
-        size_t ParseRequest(
-            std::shared_ptr< Request > request,
-            const std::string& nextRawRequestPart
+        bool FinishBodyStreaming(
+            std::shared_ptr< ConnectionState > connectionState
+        ) {
+            const auto request = connectionState->streamingRequest;
+            const auto bodyDelegate = connectionState->bodyDelegate;
+            connectionState->streamingRequest = nullptr;
+            connectionState->bodyDelegate = nullptr;
+            const auto response = bodyDelegate("", true);
+            if (response != nullptr) {
+                SendResponse(connectionState, response);
+            }
+            if (request->closeRequested) {
+                FlushOutput(connectionState);
+                connectionState->connection->Break(true);
+                return false;
+            }
+            return true;
+        }
+
+        /**
+         * This method decodes received body data for the request
+         * currently being streamed on the given connection, delivering
+         * each decoded piece to the body delegate as it arrives, so that
+         * memory per request stays bounded no matter how large the
+         * body is.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection on which
+         *      the body is being streamed.
+         *
+         * @return
+         *      An indication of whether or not the body was completed
+         *      and the connection may carry another request is returned.
+         */
+        bool DeliverRequestBody(
+            std::shared_ptr< ConnectionState > connectionState
         ) {
-            // Count the number of characters incorporated into 
-            // the request object.
-            size_t messageEnd = 0;
-            if (request->state == Request::RequestParsingState::RequestLine) {
-                // First, extarct the request line.
-                const auto requestLineEnd = nextRawRequestPart.find(CRLF);
-                if (requestLineEnd == std::string::npos) {
-                    if (nextRawRequestPart.length() > headerLineLimit) {
-                        request->state = Request::RequestParsingState::Error;
-                        return messageEnd;
+            const auto config = GetActiveConfiguration();
+            auto& buffer = connectionState->receiveBuffer;
+            if (!connectionState->chunkedBody) {
+                if (connectionState->bodyBytesRemaining > 0) {
+                    if (buffer.Available() == 0) {
+                        return false;
                     }
-                    return messageEnd;
+                    const auto pieceLength = std::min(
+                        connectionState->bodyBytesRemaining,
+                        buffer.Available()
+                    );
+                    (void)connectionState->bodyDelegate(
+                        buffer.data.substr(buffer.consumed, pieceLength),
+                        false
+                    );
+                    buffer.Consume(pieceLength);
+                    connectionState->bodyBytesRemaining -= pieceLength;
                 }
-                const auto requestLineLength = requestLineEnd;
-                if (requestLineLength > headerLineLimit) {
-                    request->state = Request::RequestParsingState::Error;
-                    return messageEnd;
+                if (connectionState->bodyBytesRemaining > 0) {
+                    return false;
                 }
-                const auto requestLine = nextRawRequestPart.substr(0, requestLineLength);
-                messageEnd = requestLineEnd + CRLF.length();
-                request->state = Request::RequestParsingState::Headers;
-                request->valid = ParseRequestLine(request, requestLine);
+                return FinishBodyStreaming(connectionState);
             }
-            //Second, parse the message headers and identify where the body begins.
-            
-            if (request->state == Request::RequestParsingState::Headers) {
-                request->headers.SetLineLimit(headerLineLimit);
-                size_t bodyOffset = 0;
-                const auto headersValidity = request->headers
-                        .ParseRawMessage(
-                            nextRawRequestPart.substr(messageEnd),
-                            bodyOffset
-                        );
-                messageEnd += bodyOffset;
-                switch (
-                    headersValidity
-                ) {
-                    case MessageHeaders::MessageHeaders::State::Complete: {
-                        // Done with parsing headers; next will be the body.
-                        if (!request->headers.IsValid()) {
-                            request->valid = false;
-                        }
-                        request->state = Request::RequestParsingState::Body;
-                        // Check for "Host" header
-                        if (request->headers.HasHeader("Host")) {
-                            const auto requestHost = request->headers.GetHeaderValue("Host");
-                            auto serverHost = configuration["Host"];
-                            if (serverHost.empty()) {
-                                serverHost = requestHost;
+            for (;;) {
+                switch (connectionState->chunkState) {
+                    case ChunkDecodeState::Size: {
+                        const auto lineEnd = FindCRLF(buffer.data, buffer.consumed);
+                        if (lineEnd == std::string::npos) {
+                            if (buffer.Available() > config->headerLineLimit) {
+                                AbortBodyStreaming(connectionState, 400);
                             }
-                            auto targetHost = request->target.GetHost();
-                            if (targetHost.empty()) {
-                                targetHost = serverHost;
+                            return false;
+                        }
+                        // Parse the hexadecimal chunk size, ignoring
+                        // any chunk extensions.
+                        size_t chunkSize = 0;
+                        bool sawDigit = false;
+                        bool sizeValid = true;
+                        auto i = buffer.consumed;
+                        for (; i < lineEnd; ++i) {
+                            const auto c = buffer.data[i];
+                            int digit;
+                            if ((c >= '0') && (c <= '9')) {
+                                digit = c - '0';
+                            } else if ((c >= 'a') && (c <= 'f')) {
+                                digit = c - 'a' + 10;
+                            } else if ((c >= 'A') && (c <= 'F')) {
+                                digit = c - 'A' + 10;
+                            } else {
+                                break;
                             }
-                            if ((requestHost != targetHost) || (requestHost != serverHost)) {
-                                request->valid = false;
+                            if (chunkSize > (SIZE_MAX >> 4)) {
+                                sizeValid = false;
+                                break;
                             }
-                            // TODO: check that target host matches server host.
+                            chunkSize = (chunkSize << 4) + digit;
+                            sawDigit = true;
+                        }
+                        if (
+                            !sawDigit
+                            || !sizeValid
+                            || (
+                                (i < lineEnd)
+                                && (buffer.data[i] != ';')
+                            )
+                        ) {
+                            AbortBodyStreaming(connectionState, 400);
+                            return false;
+                        }
+                        buffer.Consume(lineEnd + CRLF.length() - buffer.consumed);
+                        if (chunkSize == 0) {
+                            connectionState->chunkState = ChunkDecodeState::Trailer;
                         } else {
-                            request->valid = false;
+                            connectionState->bodyBytesRemaining = chunkSize;
+                            connectionState->chunkState = ChunkDecodeState::Data;
+                        }
+                    } break;
+                    case ChunkDecodeState::Data: {
+                        if (buffer.Available() == 0) {
+                            return false;
+                        }
+                        const auto pieceLength = std::min(
+                            connectionState->bodyBytesRemaining,
+                            buffer.Available()
+                        );
+                        (void)connectionState->bodyDelegate(
+                            buffer.data.substr(buffer.consumed, pieceLength),
+                            false
+                        );
+                        buffer.Consume(pieceLength);
+                        connectionState->bodyBytesRemaining -= pieceLength;
+                        if (connectionState->bodyBytesRemaining > 0) {
+                            return false;
+                        }
+                        connectionState->chunkState = ChunkDecodeState::DataCrlf;
+                    } break;
+                    case ChunkDecodeState::DataCrlf: {
+                        if (buffer.Available() < CRLF.length()) {
+                            return false;
+                        }
+                        if (buffer.data.compare(buffer.consumed, CRLF.length(), CRLF) != 0) {
+                            AbortBodyStreaming(connectionState, 400);
+                            return false;
+                        }
+                        buffer.Consume(CRLF.length());
+                        connectionState->chunkState = ChunkDecodeState::Size;
+                    } break;
+                    case ChunkDecodeState::Trailer: {
+                        const auto lineEnd = FindCRLF(buffer.data, buffer.consumed);
+                        if (lineEnd == std::string::npos) {
+                            if (buffer.Available() > config->headerLineLimit) {
+                                AbortBodyStreaming(connectionState, 400);
+                            }
+                            return false;
+                        }
+                        const auto emptyLine = (lineEnd == buffer.consumed);
+                        buffer.Consume(lineEnd + CRLF.length() - buffer.consumed);
+                        if (emptyLine) {
+                            return FinishBodyStreaming(connectionState);
                         }
                     } break;
-
-                    case MessageHeaders::MessageHeaders::State::Incomplete: {
-                    } return messageEnd;
-                    case MessageHeaders::MessageHeaders::State::Error: 
-                    default: 
-                    {
-                        request->state = Request::RequestParsingState::Error;
-                        return messageEnd;
-                    }
-                }
-            }
-
-            // Finally, extract the body.
-            if (request->state == Request::RequestParsingState::Body) {
-                // Check for "Content-Length" header, if present, use it to
-                // determine how many characters should be in the body. 
-                const auto bodyAvailableSize = nextRawRequestPart.length() - messageEnd;
-                // If it containt "Content-Length" header, we carefully carve exactly
-                // that number of cahracters out (and bail if we don't have anough) 
-                if (request->headers.HasHeader("Content-Length")) {
-                    size_t contentLength;
-                    switch (ParseSize(request->headers.GetHeaderValue("Content-Length"), contentLength)) {
-
-                        case ParseSizeResult::NotaNumber:
-                        {
-                            request->state = Request::RequestParsingState::Error;
-                            return messageEnd;
-                        } 
-                        case ParseSizeResult::Overflow:
-                        {
-                            request->state = Request::RequestParsingState::Error;
-                            request->responseStatusCode = 413;
-                            request->responseStatusPhrase = "Payload Too Large";
-                            return messageEnd;
-                        } 
-                        
-                    }
-                    if (contentLength > MAX_CONTENT_LENGTH) {
-                        request->state = Request::RequestParsingState::Error;
-                        request->responseStatusCode = 413;
-                        request->responseStatusPhrase = "Payload Too Large";
-                        return messageEnd;
-                    } 
-                    if (contentLength > bodyAvailableSize) {
-                        request->state = Request::RequestParsingState::Body;
-                        return messageEnd;
-                    } else {
-                        request->body = nextRawRequestPart.substr(messageEnd, contentLength);
-                        messageEnd += contentLength;
-                        request->state = Request::RequestParsingState::Complete;
-                    }
-                } else {
-                    //Finally, extract the body
-                    request->body.clear();
-                    request->state = Request::RequestParsingState::Complete;
                 }
             }
-            return messageEnd;
         }
 
         /**
-         * This method is called when new data is received from a connection
-         * 
+         * This method routes the given fully-assembled request to the
+         * registered resource delegate (if any), and sends the response
+         * back through the given connection.
+         *
          * @param[in] connectionState
-         *      This is the connection state of the connection from which 
-         *      data was received.
-         * 
-         * @param[in] data
-         *      This is a copy of the data that was received from 
-         *      the connection.
+         *      This is the connection state of the connection from which
+         *      the request was received.
+         *
+         * @param[in] request
+         *      This is the request to process.
          */
-        void DataReceived(
+        void ProcessRequest(
             std::shared_ptr< ConnectionState > connectionState,
-            std::vector< uint8_t > data
+            std::shared_ptr< Request > request
         ) {
-            connectionState->concatenateBuffer += std::string(data.begin(), data.end());
-            for (;;) {
-                const auto request = TryRequestAssembly(connectionState);
-                if (request == nullptr) {
-                    break;
+            double serviceStartTime = 0.0;
+            if (timeKeeper != nullptr) {
+                serviceStartTime = timeKeeper->GetCurrentTime();
+            }
+            if (
+                (request->state == Request::RequestParsingState::Complete)
+                && request->valid
+            ) {
+                diagnosticsSender.SendDiagnosticInformationFormatted(
+                    1,
+                    "Received %s request for '%s' from %s",
+                    request->method.c_str(),
+                    request->target.GenerateString().c_str(),
+                    connectionState->connection->GetPeerId().c_str()
+                );
+                const auto routeTable = GetActiveRouteTable();
+                const auto originalResourcePath = request->target.GetPath();
+                size_t firstSegment = 0;
+                if (
+                    !originalResourcePath.empty()
+                    && (originalResourcePath.front() == "")
+                ) {
+                    ++firstSegment;
                 }
-                std::string responseText;
-                unsigned int statusCode;
-                std::string status;
+                size_t segmentsMatched = firstSegment;
+                const auto& handlers = routeTable->Match(
+                    originalResourcePath,
+                    firstSegment,
+                    segmentsMatched
+                );
                 if (
-                    (request->state == Request::RequestParsingState::Complete)
-                    && request->valid
+                    (handlers.handler != nullptr)
+                    || (handlers.streamingHandler != nullptr)
+                    || (handlers.asyncHandler != nullptr)
                 ) {
-                    diagnosticsSender.SendDiagnosticInformationFormatted(
-                        1,
-                        "Received %s request for '%s' from %s",
-                        request->method.c_str(),
-                        request->target.GenerateString().c_str(),
-                        connectionState->connection->GetPeerId().c_str()
-                    );
-                    const auto originalResourcePath = request->target.GetPath();
-                    std::deque< std::string > resourcePath(
-                        originalResourcePath.begin(),
-                        originalResourcePath.end()
+                    request->target.SetPath(
+                        std::vector< std::string >(
+                            originalResourcePath.begin() + segmentsMatched,
+                            originalResourcePath.end()
+                        )
                     );
-                    if (
-                        !resourcePath.empty()
-                        && (resourcePath.front() == "")
-                    ) {
-                        (void)resourcePath.pop_front();
-                    }
-                    std::shared_ptr< ResourceSpace > resource = resources;
-                    while (
-                        (resource != nullptr) 
-                        && !resourcePath.empty()
-                    ) {
-                        const auto subspaceEntry = resource->subspaces.find(resourcePath.front());
-                        if (subspaceEntry == resource->subspaces.end()) {
-                            break;
-                        } else {
-                            resource = subspaceEntry->second;
-                            resourcePath.pop_front();
+                    std::shared_ptr< Client::Response > response;
+                    if (handlers.asyncHandler != nullptr) {
+                        // Park a slot for this request's response and
+                        // hand the handler a completion delegate; the
+                        // connection keeps being serviced, and the
+                        // response goes out in its turn once the
+                        // handler delivers it.
+                        const auto slot = std::make_shared< PendingResponse >();
+                        connectionState->pendingResponses.push_back(slot);
+                        std::weak_ptr< ConnectionState > connectionStateWeak(connectionState);
+                        handlers.asyncHandler(
+                            request,
+                            [this, connectionStateWeak, slot](std::shared_ptr< Client::Response > response){
+                                const auto connectionState = connectionStateWeak.lock();
+                                if (connectionState == nullptr) {
+                                    return;
+                                }
+                                std::lock_guard< decltype(connectionState->mutex) > lock(connectionState->mutex);
+                                slot->response = response;
+                                slot->ready = true;
+                                DrainPendingResponses(connectionState);
+                                FlushOutput(connectionState);
+                            }
+                        );
+                    } else if (handlers.handler != nullptr) {
+                        response = handlers.handler(request);
+                    } else {
+                        // The body of this request was buffered before
+                        // streaming could begin (or couldn't be framed
+                        // for streaming); deliver it to the streaming
+                        // handler as a single piece.
+                        const auto bodyDelegate = handlers.streamingHandler(request);
+                        if (bodyDelegate != nullptr) {
+                            response = bodyDelegate(request->body, true);
                         }
                     }
-                    if (
-                        (resource != nullptr)
-                        && (resource->handler != nullptr)
-                    ) {
-                        request->target.SetPath({resourcePath.begin(), resourcePath.end()});
-                        const auto response = resource->handler(request);
-                        if(
-                            !response->headers.HasHeader("Transfer-Encoding")
-                            && !response->body.empty()
-                            && !response->headers.HasHeader("Content-Length")
-                        ) {
-                            response->headers.AddHeader(
-                                "Content-Length",
-                                StringUtils::sprintf("%zu", response->body.length())
-                            );
-                        }
-                        responseText = response->GenerateToString();
-                        statusCode = response->statusCode;
-                        status = response->status;  
-                    } else {
-                        const std::string cannedResponse = (
-                            "HTTP/1.1 404 Not Found\r\n"
-                            "Content-Length: 13\r\n"
-                            "Content-Type: text/plain\r\n"
-                            "\r\n"
-                            "BadRequest.\r\n"
-                        );
-                        responseText = cannedResponse;
-                        statusCode = 404;
-                        status = "Not Found";
-                    }    
-                } else if (
-                    (request->state == Request::RequestParsingState::Error)
-                    && (request->responseStatusCode == 413)
-                ){
-                    const std::string response = (
-                        StringUtils::sprintf("HTTP/1.1 %u %s\r\n"
-                            "Content-Length: 13\r\n"
-                            "Content-Type: text/plain\r\n"
-                            "\r\n"
-                            "BadRequest.\r\n",
-                            request->responseStatusCode,
-                            request->responseStatusPhrase.c_str()
-                        )
-                    );
-                    responseText = response;
-                    statusCode = request->responseStatusCode;
-                    status = request->responseStatusPhrase;
+                    if (response != nullptr) {
+                        SendResponse(connectionState, response);
+                    }
                 } else {
-                    const std::string cannedResponse = (
-                        "HTTP/1.1 400 Bad Request\r\n"
-                        "Content-Length: 13\r\n"
-                        "Content-Type: text/plain\r\n"
-                        "\r\n"
-                        "BadRequest.\r\n"
-                    );
-                    responseText = cannedResponse;
-                    statusCode = 400;
-                    status = "Bad Request";
+                    SendCannedResponse(connectionState, 404);
                 }
+            } else if (
+                (request->state == Request::RequestParsingState::Error)
+                && (request->responseStatusCode == 413)
+            ){
+                parseErrors.fetch_add(1, std::memory_order_relaxed);
+                SendCannedResponse(connectionState, request->responseStatusCode);
+            } else {
+                parseErrors.fetch_add(1, std::memory_order_relaxed);
+                SendCannedResponse(connectionState, 400);
+            }
+            if (timeKeeper != nullptr) {
+                RecordServiceLatency(timeKeeper->GetCurrentTime() - serviceStartTime);
+            }
+            const bool closeConnection = (
+                (
+                    (request->state == Request::RequestParsingState::Complete)
+                    && request->closeRequested
+                )
+                || (request->state == Request::RequestParsingState::Error)
+            );
+            if (closeConnection) {
+                CloseAfterOutput(connectionState);
+            }
+        }
 
-                connectionState->connection->SendData(
-                    std::vector< uint8_t >(
-                        responseText.begin(),
-                        responseText.end()
-                    )
-                );
-                diagnosticsSender.SendDiagnosticInformationFormatted(
-                    1,
-                    "Sent %u '%s' response back to %s",
-                    statusCode,
-                    status.c_str(),
-                    connectionState->connection->GetPeerId().c_str()
+        /**
+         * This method queues the given fully-assembled request to be
+         * handled by a worker thread, scheduling the connection for
+         * service if it isn't already, so that responses go back in
+         * the order the requests came in.
+         *
+         * @param[in] connectionState
+         *      This is the connection state of the connection from which
+         *      the request was received.
+         *
+         * @param[in] request
+         *      This is the request to queue.
+         */
+        void DispatchRequest(
+            std::shared_ptr< ConnectionState > connectionState,
+            std::shared_ptr< Request >&& request
+        ) {
+            connectionState->requestsReady.push_back(std::move(request));
+            if (!connectionState->workerScheduled) {
+                connectionState->workerScheduled = true;
+                std::lock_guard< decltype(workerMutex) > lock(workerMutex);
+                connectionsReadyToProcess.push_back(connectionState);
+                workerCondition.notify_one();
+            }
+        }
+
+        /**
+         * This method is the body of each worker thread.
+         * Until it's told to stop, it takes connections off the ready
+         * queue and processes their assembled requests, one connection
+         * at a time so that responses stay in order per connection.
+         */
+        void Worker() {
+            std::unique_lock< decltype(workerMutex) > lock(workerMutex);
+            while (!stopWorkers) {
+                workerCondition.wait(
+                    lock,
+                    [this]{
+                        return (
+                            stopWorkers || !connectionsReadyToProcess.empty()
+                        );
+                    }
                 );
-                if (request->state == Request::RequestParsingState::Complete) {
-                    const auto connectionTockens = request->headers.GetHeaderMultiValues("Connection");
-                    bool closeRequested = false;
-                    for (const auto& connectionTocken: connectionTockens) {
-                        if (connectionTocken == "close") {
-                            closeRequested = true;
-                            break;
+                while (!connectionsReadyToProcess.empty()) {
+                    const auto connectionState = connectionsReadyToProcess.front();
+                    connectionsReadyToProcess.pop_front();
+                    lock.unlock();
+                    {
+                        std::lock_guard< decltype(connectionState->mutex) > connectionLock(connectionState->mutex);
+                        while (!connectionState->requestsReady.empty()) {
+                            auto request = std::move(connectionState->requestsReady.front());
+                            connectionState->requestsReady.pop_front();
+                            ProcessRequest(connectionState, request);
+                            connectionState->RecycleRequest(std::move(request));
+                        }
+                        FlushOutput(connectionState);
+                        connectionState->workerScheduled = false;
+                        if (connectionState->receivePaused) {
+                            // The connection's responses have drained;
+                            // let the transport feed us its data again.
+                            connectionState->receivePaused = false;
+                            connectionState->connection->SetReceivePaused(false);
                         }
                     }
-                    if (closeRequested) {
-                        connectionState->connection->Break(true);
-                    }
-                } else {
-                    if(request->state == Request::RequestParsingState::Error) {
-                        connectionState->connection->Break(true);
-                    }
-                    break;
+                    lock.lock();
                 }
             }
         }
@@ -645,9 +3026,16 @@ namespace Http {
          * 
          * @param[in] connection
          *      This is the new connection has been established for the server.
+         *
+         * @param[in] shard
+         *      This is the index of the connection table shard
+         *      belonging to the listener through which the connection
+         *      was accepted.
          */
-        void NewConnection(std::shared_ptr< Connection > connection) {
-            std::lock_guard< decltype(mutex) > lock(mutex);
+        void NewConnection(
+            std::shared_ptr< Connection > connection,
+            size_t shard
+        ) {
             diagnosticsSender.SendDiagnosticInformationFormatted(
                 2,
                 "New connection from %s",
@@ -655,36 +3043,45 @@ namespace Http {
             );
             const auto connectionState = std::make_shared< ConnectionState >();
             connectionState->connection = connection;
-            (void)establishedConnections.insert(connectionState);
+            connectionState->shard = shard;
+            {
+                std::lock_guard< decltype(connectionShards[shard].mutex) > lock(connectionShards[shard].mutex);
+                (void)connectionShards[shard].establishedConnections.insert(connectionState);
+            }
+            if (timeKeeper != nullptr) {
+                connectionState->lastActivityTime = timeKeeper->GetCurrentTime();
+                std::lock_guard< decltype(timerMutex) > timerLock(timerMutex);
+                ScheduleTimeout(
+                    connectionState,
+                    connectionState->lastActivityTime + GetActiveConfiguration()->inactivityTimeout
+                );
+            }
             std::weak_ptr< ConnectionState > connectionStateWeak(connectionState);
             connectionState->connection->SetDataReceivedDelegate(
-                [this, connectionStateWeak](std::vector< uint8_t > data){
-                    std::lock_guard< decltype(mutex) > lock(mutex);
+                [this, connectionStateWeak](std::vector< uint8_t >&& data){
                     const auto connectionState = connectionStateWeak.lock();
                     if (connectionState == nullptr) {
                         return;
                     }
+                    std::lock_guard< decltype(connectionState->mutex) > lock(connectionState->mutex);
                     DataReceived(
                         connectionState,
-                        data
+                        std::move(data)
                     );
                 }
             );
             connection->SetConnectionBrokenDelegate(
                 [this, connectionStateWeak](bool graceful){
-                    std::lock_guard< decltype(mutex) > lock(mutex);
                     const auto connectionState = connectionStateWeak.lock();
                     if (connectionState == nullptr) {
                         return;
                     }
                     diagnosticsSender.SendDiagnosticInformationFormatted(
-                        2, 
+                        2,
                         "Connection to %s is broken by peer",
                         connectionState->connection->GetPeerId().c_str()
                     );
-                    (void)brokenConnections.insert(connectionState);
-                    condition.notify_all();
-                    (void)establishedConnections.erase(connectionState);
+                    QueueBrokenConnection(connectionState);
                 }
             );
         }
@@ -697,50 +3094,145 @@ namespace Http {
         );
     }
 
+    void Server::Request::Reset() {
+        valid = true;
+        method.clear();
+        knownMethod = KnownMethod::Unknown;
+        target = Uri::Uri();
+        headers = MessageHeaders::MessageHeaders();
+        body.clear();
+        state = RequestParsingState::RequestLine;
+        responseStatusCode = 400;
+        responseStatusPhrase = "Bad Request";
+        rawHeaders.clear();
+        headersLineStart = 0;
+        hasHost = false;
+        host.clear();
+        hasContentLength = false;
+        contentLength = 0;
+        closeRequested = false;
+    }
+
     Server::~Server() {
         Demobilize();
         {
-            std::lock_guard< decltype(impl_->mutex) > lock(impl_->mutex);
+            std::lock_guard< decltype(impl_->reaperMutex) > lock(impl_->reaperMutex);
             impl_->stopReaper = true;
             impl_->condition.notify_all();
         }
         impl_->reaper.join();
+        impl_->ReapBrokenConnections();
     };
 
     Server::Server()
          : impl_(new Impl) {
             impl_->server = this;
             impl_->configuration["HeaderLineLimit"] = StringUtils::sprintf("%zu", DEFAULT_HEADER_LINE_LIMIT);
+            impl_->configuration["WorkerThreads"] = StringUtils::sprintf("%zu", DEFAULT_WORKER_THREADS);
+            impl_->configuration["InactivityTimeout"] = StringUtils::sprintf("%lf", DEFAULT_INACTIVITY_TIMEOUT_SECONDS);
+            impl_->configuration["RequestTimeout"] = StringUtils::sprintf("%lf", DEFAULT_REQUEST_TIMEOUT_SECONDS);
+            impl_->configuration["ConnectionBufferLimit"] = StringUtils::sprintf("%zu", DEFAULT_CONNECTION_BUFFER_LIMIT);
+            impl_->configuration["TotalBufferLimit"] = StringUtils::sprintf("%zu", DEFAULT_TOTAL_BUFFER_LIMIT);
             impl_->reaper = std::thread(&Impl::Reaper, impl_.get());
     }
 
        bool Server::Mobilize(const
         MobilizationDependencies& dep
     ) {
-        impl_->transport = dep.transport;
-        if (impl_->transport->BindNetwork(
-            dep.port,
-            [this](std::shared_ptr< Connection > connection) {
-                impl_->NewConnection(connection);
-            }
-        )) { 
-            impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
-                3,
-                "Now listening on port %" PRIu16,
-                dep.port
-            );
-        } else {
-            impl_->transport = nullptr;
-            return false;
+        impl_->timeKeeper = dep.timeKeeper;
+        std::vector< TransportBinding > bindings;
+        bindings.push_back({dep.transport, dep.port});
+        for (const auto& extraBinding: dep.extraBindings) {
+            bindings.push_back(extraBinding);
+        }
+        // The shard deque only ever grows, so that connections which
+        // outlive a demobilization can still find their shard.
+        while (impl_->connectionShards.size() < bindings.size()) {
+            impl_->connectionShards.emplace_back();
+        }
+        for (size_t shard = 0; shard < bindings.size(); ++shard) {
+            const auto& binding = bindings[shard];
+            if (binding.transport->BindNetwork(
+                binding.port,
+                [this, shard](std::shared_ptr< Connection > connection) {
+                    impl_->NewConnection(connection, shard);
+                }
+            )) {
+                impl_->transports.push_back(binding.transport);
+                impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
+                    3,
+                    "Now listening on port %" PRIu16,
+                    binding.port
+                );
+            } else {
+                for (const auto& transport: impl_->transports) {
+                    transport->ReleaseNetwork();
+                }
+                impl_->transports.clear();
+                impl_->timeKeeper = nullptr;
+                return false;
+            }
+        }
+        // All of the listeners are bound; only now start the worker
+        // and timer threads, so that a failed bind leaves no threads
+        // running and a retried Mobilize doesn't start a second set.
+        impl_->stopWorkers = false;
+        for (size_t i = 0; i < impl_->workerThreadCount; ++i) {
+            impl_->workers.emplace_back(&Impl::Worker, impl_.get());
+        }
+        if (impl_->timeKeeper != nullptr) {
+            impl_->stopTimer = false;
+            impl_->timer = std::thread(&Impl::Timer, impl_.get());
         }
         return true;
     }
 
+    auto Server::GetStatistics() -> Statistics {
+        Statistics statistics;
+        statistics.requestsServed = impl_->requestsServed.load(std::memory_order_relaxed);
+        statistics.bytesReceived = impl_->bytesReceived.load(std::memory_order_relaxed);
+        statistics.bytesSent = impl_->bytesSent.load(std::memory_order_relaxed);
+        statistics.parseErrors = impl_->parseErrors.load(std::memory_order_relaxed);
+        statistics.latencyBuckets.reserve(LATENCY_BUCKET_COUNT);
+        for (const auto& latencyBucket: impl_->latencyBuckets) {
+            statistics.latencyBuckets.push_back(latencyBucket.load(std::memory_order_relaxed));
+        }
+        statistics.activeConnections = 0;
+        for (auto& shard: impl_->connectionShards) {
+            std::lock_guard< decltype(shard.mutex) > lock(shard.mutex);
+            statistics.activeConnections += shard.establishedConnections.size();
+        }
+        return statistics;
+    }
+
     void Server::Demobilize() {
-        if (impl_->transport != nullptr) {
-            impl_->transport->ReleaseNetwork();
-            impl_->transport = nullptr;
+        if (impl_->timer.joinable()) {
+            {
+                std::lock_guard< decltype(impl_->timerMutex) > lock(impl_->timerMutex);
+                impl_->stopTimer = true;
+                impl_->timerCondition.notify_all();
+            }
+            impl_->timer.join();
+            for (auto& slot: impl_->timerWheel) {
+                slot.clear();
+            }
+        }
+        impl_->timeKeeper = nullptr;
+        if (!impl_->workers.empty()) {
+            {
+                std::lock_guard< decltype(impl_->workerMutex) > lock(impl_->workerMutex);
+                impl_->stopWorkers = true;
+                impl_->workerCondition.notify_all();
+            }
+            for (auto& worker: impl_->workers) {
+                worker.join();
+            }
+            impl_->workers.clear();
+        }
+        for (const auto& transport: impl_->transports) {
+            transport->ReleaseNetwork();
         }
+        impl_->transports.clear();
     }
     
     auto Server::ParseRequest(const std::string& rawRequest)-> std::shared_ptr< Request > {
@@ -768,7 +3260,14 @@ namespace Http {
 
     void Server::SetConfigurationItem(const std::string& key, const std::string& value) {
         impl_->configuration[key] = value;
-        if (key == "HeaderLineLimit") {
+        // The hot paths read the configuration through an immutable
+        // snapshot; build a modified copy and publish it whole, so
+        // events in progress finish with a consistent configuration.
+        auto newConfiguration = *impl_->GetActiveConfiguration();
+        if (key == "Host") {
+            newConfiguration.host = value;
+            impl_->PublishConfiguration(newConfiguration);
+        } else if (key == "HeaderLineLimit") {
             size_t newHeaderLineLimit;
             if (
                 sscanf(
@@ -780,10 +3279,100 @@ namespace Http {
                 impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
                     0,
                     "Header line limit changed from %zu to %zu",
-                    impl_->headerLineLimit,
+                    newConfiguration.headerLineLimit,
                     newHeaderLineLimit
                 );
-                impl_->headerLineLimit = newHeaderLineLimit;
+                newConfiguration.headerLineLimit = newHeaderLineLimit;
+                impl_->PublishConfiguration(newConfiguration);
+            }
+        } else if (key == "WorkerThreads") {
+            size_t newWorkerThreadCount;
+            if (
+                sscanf(
+                    value.c_str(),
+                    "%zu",
+                    &newWorkerThreadCount
+                ) == 1
+            ) {
+                impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
+                    0,
+                    "Worker thread count changed from %zu to %zu",
+                    impl_->workerThreadCount,
+                    newWorkerThreadCount
+                );
+                impl_->workerThreadCount = newWorkerThreadCount;
+            }
+        } else if (key == "InactivityTimeout") {
+            double newInactivityTimeout;
+            if (
+                sscanf(
+                    value.c_str(),
+                    "%lf",
+                    &newInactivityTimeout
+                ) == 1
+            ) {
+                impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
+                    0,
+                    "Inactivity timeout changed from %lf to %lf",
+                    newConfiguration.inactivityTimeout,
+                    newInactivityTimeout
+                );
+                newConfiguration.inactivityTimeout = newInactivityTimeout;
+                impl_->PublishConfiguration(newConfiguration);
+            }
+        } else if (key == "RequestTimeout") {
+            double newRequestTimeout;
+            if (
+                sscanf(
+                    value.c_str(),
+                    "%lf",
+                    &newRequestTimeout
+                ) == 1
+            ) {
+                impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
+                    0,
+                    "Request timeout changed from %lf to %lf",
+                    newConfiguration.requestTimeout,
+                    newRequestTimeout
+                );
+                newConfiguration.requestTimeout = newRequestTimeout;
+                impl_->PublishConfiguration(newConfiguration);
+            }
+        } else if (key == "ConnectionBufferLimit") {
+            size_t newConnectionBufferLimit;
+            if (
+                sscanf(
+                    value.c_str(),
+                    "%zu",
+                    &newConnectionBufferLimit
+                ) == 1
+            ) {
+                impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
+                    0,
+                    "Connection buffer limit changed from %zu to %zu",
+                    newConfiguration.connectionBufferLimit,
+                    newConnectionBufferLimit
+                );
+                newConfiguration.connectionBufferLimit = newConnectionBufferLimit;
+                impl_->PublishConfiguration(newConfiguration);
+            }
+        } else if (key == "TotalBufferLimit") {
+            size_t newTotalBufferLimit;
+            if (
+                sscanf(
+                    value.c_str(),
+                    "%zu",
+                    &newTotalBufferLimit
+                ) == 1
+            ) {
+                impl_->diagnosticsSender.SendDiagnosticInformationFormatted(
+                    0,
+                    "Total buffer limit changed from %zu to %zu",
+                    newConfiguration.totalBufferLimit,
+                    newTotalBufferLimit
+                );
+                newConfiguration.totalBufferLimit = newTotalBufferLimit;
+                impl_->PublishConfiguration(newConfiguration);
             }
         }
     }
@@ -798,15 +3387,58 @@ namespace Http {
 
    
     auto Server::RegisterResource(
-            const std::vector< std::string >& resourceSubspacePath, 
+            const std::vector< std::string >& resourceSubspacePath,
             ResourceDelegate resourceDelegate
     ) -> UnregistrationDelegate {
+        return RegisterResourceHandlers(
+            resourceSubspacePath,
+            resourceDelegate,
+            nullptr,
+            nullptr
+        );
+    }
+
+    auto Server::RegisterStreamingResource(
+            const std::vector< std::string >& resourceSubspacePath,
+            StreamingResourceDelegate streamingResourceDelegate
+    ) -> UnregistrationDelegate {
+        return RegisterResourceHandlers(
+            resourceSubspacePath,
+            nullptr,
+            streamingResourceDelegate,
+            nullptr
+        );
+    }
+
+    auto Server::RegisterAsyncResource(
+            const std::vector< std::string >& resourceSubspacePath,
+            AsyncResourceDelegate asyncResourceDelegate
+    ) -> UnregistrationDelegate {
+        return RegisterResourceHandlers(
+            resourceSubspacePath,
+            nullptr,
+            nullptr,
+            asyncResourceDelegate
+        );
+    }
+
+    auto Server::RegisterResourceHandlers(
+            const std::vector< std::string >& resourceSubspacePath,
+            ResourceDelegate resourceDelegate,
+            StreamingResourceDelegate streamingResourceDelegate,
+            AsyncResourceDelegate asyncResourceDelegate
+    ) -> UnregistrationDelegate {
+        std::lock_guard< decltype(impl_->registrationMutex) > lock(impl_->registrationMutex);
         std::shared_ptr< ResourceSpace > space =  impl_->resources;
         if (space == nullptr) {
             space = impl_->resources = std::make_shared< ResourceSpace >();
         }
         for (const auto& pathSegment: resourceSubspacePath) {
-            if (space->handler != nullptr) {
+            if (
+                (space->handler != nullptr)
+                || (space->streamingHandler != nullptr)
+                || (space->asyncHandler != nullptr)
+            ) {
                 return nullptr;
             }
             std::shared_ptr< ResourceSpace > subspace;
@@ -822,16 +3454,26 @@ namespace Http {
         }
         if (
             space->handler == nullptr
+            && (space->streamingHandler == nullptr)
+            && (space->asyncHandler == nullptr)
             && (space->subspaces.empty())
         ) {
             space->handler = resourceDelegate;
+            space->streamingHandler = streamingResourceDelegate;
+            space->asyncHandler = asyncResourceDelegate;
+            impl_->PublishRouteTable(BuildRouteTable(impl_->resources));
             return [this, space]{
+                std::lock_guard< decltype(impl_->registrationMutex) > lock(impl_->registrationMutex);
                 auto currentSpace = space;
                 currentSpace->handler = nullptr;
+                currentSpace->streamingHandler = nullptr;
+                currentSpace->asyncHandler = nullptr;
                 for (;;) {
                     auto superspace = currentSpace->superspace.lock();
                     if (
                         (currentSpace->handler == nullptr)
+                        && (currentSpace->streamingHandler == nullptr)
+                        && (currentSpace->asyncHandler == nullptr)
                         && currentSpace->subspaces.empty()
                     ) {
                         if (superspace == nullptr) {
@@ -841,15 +3483,16 @@ namespace Http {
                             (void)superspace->subspaces.erase(currentSpace->name);
                         }
                     }
-                    if ( 
-                        (superspace != nullptr) 
+                    if (
+                        (superspace != nullptr)
                         && superspace->subspaces.empty()
                     ) {
                         currentSpace = superspace;
                     } else {
                         break;
                     }
-                }   
+                }
+                impl_->PublishRouteTable(BuildRouteTable(impl_->resources));
             };
         } else {
             return nullptr;
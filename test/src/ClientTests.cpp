@@ -7,7 +7,88 @@
 
 #include <gtest/gtest.h>
 #include <Http/Client.hpp>
+#include <Http/Connection.hpp>
+#include <memory>
+#include <stdint.h>
+#include <string>
 #include <Uri/Uri.hpp>
+#include <vector>
+
+namespace {
+
+    /**
+     * This is a fake connection to a server, used to test the client's
+     * request engine.
+     */
+    struct MockServerConnection : public Http::Connection {
+        // Properties
+
+        /**
+         * This is the delegate to call whenever data is received from
+         * the remote peer.
+         */
+        DataReceivedDelegate dataReceivedDelegate;
+
+        /**
+         * This is the delegate to call whenever connection has been broken.
+         */
+        BrokenDelegate brokenDelegate;
+
+        /**
+         * This is the data the client has sent through the connection.
+         */
+        std::vector< uint8_t > dataSent;
+
+        /**
+         * This flag is set if the client breaks the connection.
+         */
+        bool broken = false;
+
+        // Http::Connection
+
+        virtual std::string GetPeerId() override {
+            return "mock-server";
+        }
+
+        virtual void SetDataReceivedDelegate(DataReceivedDelegate newDataReceivedDelegate) override {
+            dataReceivedDelegate = newDataReceivedDelegate;
+        }
+
+        virtual void SetConnectionBrokenDelegate(BrokenDelegate newBrokenDelegate) override {
+            brokenDelegate = newBrokenDelegate;
+        }
+
+        virtual void SendData(const std::vector< uint8_t >& data) override {
+            (void)dataSent.insert(
+                dataSent.end(),
+                data.begin(),
+                data.end()
+            );
+        }
+
+        virtual void Break(bool clean) override {
+            broken = true;
+        }
+    };
+
+    /**
+     * This function builds a request for the given target URI, the way
+     * a user of the client would hand one to SendRequest.
+     *
+     * @param[in] targetUri
+     *      This is the URI of the target resource of the request.
+     *
+     * @return
+     *      The request is returned.
+     */
+    std::shared_ptr< Http::Client::Request > MakeRequest(const std::string& targetUri) {
+        const auto request = std::make_shared< Http::Client::Request >();
+        request->method = "GET";
+        (void)request->target.ParseFromString(targetUri);
+        return request;
+    }
+
+}
 
 TEST(ClientTests, ClientTests_ParseGetResponse_Test) {
     Http::Client client;
@@ -143,3 +224,180 @@ TEST(ClientTests, ClientTests_ResponseToString_Test) {
         response.GenerateToString()
     );    
 }
+
+TEST(ClientTests, SendRequestThroughConnectionFactory) {
+    Http::Client client;
+    const auto connection = std::make_shared< MockServerConnection >();
+    std::vector< std::string > connectionsRequested;
+    client.SetConnectionFactory(
+        [connection, &connectionsRequested](
+            const std::string& hostNameOrAddress,
+            uint16_t port
+        ) -> std::shared_ptr< Http::Connection > {
+            connectionsRequested.push_back(
+                hostNameOrAddress + ":" + std::to_string(port)
+            );
+            return connection;
+        }
+    );
+    std::vector< std::shared_ptr< Http::Client::Response > > responsesReceived;
+    ASSERT_TRUE(
+        client.SendRequest(
+            MakeRequest("http://www.example.com/foo"),
+            [&responsesReceived](std::shared_ptr< Http::Client::Response > response){
+                responsesReceived.push_back(response);
+            }
+        )
+    );
+    ASSERT_EQ(
+        (std::vector< std::string >{ "www.example.com:80" }),
+        connectionsRequested
+    );
+    const std::string rawRequest(
+        connection->dataSent.begin(),
+        connection->dataSent.end()
+    );
+    EXPECT_EQ("GET ", rawRequest.substr(0, 4));
+    EXPECT_NE(std::string::npos, rawRequest.find("Host: www.example.com\r\n"));
+    EXPECT_TRUE(responsesReceived.empty());
+    const std::string rawResponse = (
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "Hello"
+    );
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            rawResponse.begin(),
+            rawResponse.end()
+        )
+    );
+    ASSERT_EQ(1, responsesReceived.size());
+    ASSERT_FALSE(responsesReceived[0] == nullptr);
+    EXPECT_EQ(200, responsesReceived[0]->statusCode);
+    EXPECT_EQ("Hello", responsesReceived[0]->body);
+}
+
+TEST(ClientTests, PipelinedResponsesMatchedToRequestsInOrder) {
+    Http::Client client;
+    const auto connection = std::make_shared< MockServerConnection >();
+    size_t connectionsRequested = 0;
+    client.SetConnectionFactory(
+        [connection, &connectionsRequested](
+            const std::string& hostNameOrAddress,
+            uint16_t port
+        ) -> std::shared_ptr< Http::Connection > {
+            ++connectionsRequested;
+            return connection;
+        }
+    );
+    std::vector< std::string > bodiesReceived;
+    ASSERT_TRUE(
+        client.SendRequest(
+            MakeRequest("http://www.example.com/first"),
+            [&bodiesReceived](std::shared_ptr< Http::Client::Response > response){
+                bodiesReceived.push_back("first:" + response->body);
+            }
+        )
+    );
+    ASSERT_TRUE(
+        client.SendRequest(
+            MakeRequest("http://www.example.com/second"),
+            [&bodiesReceived](std::shared_ptr< Http::Client::Response > response){
+                bodiesReceived.push_back("second:" + response->body);
+            }
+        )
+    );
+    // Both requests must have been pipelined through the one pooled
+    // connection, in the order they were sent.
+    EXPECT_EQ(1, connectionsRequested);
+    const std::string rawRequests(
+        connection->dataSent.begin(),
+        connection->dataSent.end()
+    );
+    const auto firstRequestOffset = rawRequests.find("/first");
+    const auto secondRequestOffset = rawRequests.find("/second");
+    ASSERT_NE(std::string::npos, firstRequestOffset);
+    ASSERT_NE(std::string::npos, secondRequestOffset);
+    EXPECT_LT(firstRequestOffset, secondRequestOffset);
+    // The server answers both in one arrival; each response must be
+    // delivered to the delegate of the request it answers.
+    const std::string rawResponses = (
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 1\r\n"
+        "\r\n"
+        "A"
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 1\r\n"
+        "\r\n"
+        "B"
+    );
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            rawResponses.begin(),
+            rawResponses.end()
+        )
+    );
+    EXPECT_EQ(
+        (std::vector< std::string >{ "first:A", "second:B" }),
+        bodiesReceived
+    );
+}
+
+TEST(ClientTests, UnsolicitedDataFailsConnection) {
+    Http::Client client;
+    const auto connection = std::make_shared< MockServerConnection >();
+    size_t connectionsRequested = 0;
+    client.SetConnectionFactory(
+        [connection, &connectionsRequested](
+            const std::string& hostNameOrAddress,
+            uint16_t port
+        ) -> std::shared_ptr< Http::Connection > {
+            ++connectionsRequested;
+            return connection;
+        }
+    );
+    std::vector< std::shared_ptr< Http::Client::Response > > responsesReceived;
+    ASSERT_TRUE(
+        client.SendRequest(
+            MakeRequest("http://www.example.com/foo"),
+            [&responsesReceived](std::shared_ptr< Http::Client::Response > response){
+                responsesReceived.push_back(response);
+            }
+        )
+    );
+    const std::string rawResponse = (
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n"
+    );
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            rawResponse.begin(),
+            rawResponse.end()
+        )
+    );
+    ASSERT_EQ(1, responsesReceived.size());
+    EXPECT_FALSE(connection->broken);
+    // Nothing is in flight now, so further bytes from the server are
+    // unsolicited; the client must not buffer them without bound.
+    const std::string unsolicited = "HTTP/1.1 200 OK\r\n";
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            unsolicited.begin(),
+            unsolicited.end()
+        )
+    );
+    EXPECT_TRUE(connection->broken);
+    // The failed connection must have left the pool: the next request
+    // establishes a new connection.
+    ASSERT_TRUE(
+        client.SendRequest(
+            MakeRequest("http://www.example.com/foo"),
+            [&responsesReceived](std::shared_ptr< Http::Client::Response > response){
+                responsesReceived.push_back(response);
+            }
+        )
+    );
+    EXPECT_EQ(2, connectionsRequested);
+}
@@ -0,0 +1,124 @@
+/**
+ * @file FileServerTests.cpp
+ *
+ * This module contains tests units of the
+ * Http::FileServer class.
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <memory>
+#include <Http/FileServer.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+
+    /**
+     * This function writes the given contents into the file with the
+     * given path, replacing whatever the file held before.
+     *
+     * @param[in] path
+     *      This is the path of the file to write.
+     *
+     * @param[in] contents
+     *      These are the contents to write into the file.
+     */
+    void WriteFile(
+        const std::string& path,
+        const std::string& contents
+    ) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file << contents;
+    }
+
+    /**
+     * This function builds a request whose target path consists of the
+     * given segments, the way the server hands requests to a resource
+     * delegate after stripping the matched subspace.
+     *
+     * @param[in] path
+     *      These are the segments of the target path of the request.
+     *
+     * @return
+     *      The request is returned.
+     */
+    std::shared_ptr< Http::IServer::Request > MakeRequest(
+        const std::vector< std::string >& path
+    ) {
+        const auto request = std::make_shared< Http::IServer::Request >();
+        request->method = "GET";
+        request->target.SetPath(path);
+        return request;
+    }
+
+}
+
+TEST(FileServerTests, ServeFileWithSizeAndContentType) {
+    const std::string rootDirectory = ::testing::TempDir();
+    WriteFile(rootDirectory + "/hello.txt", "Hello, World!\r\n");
+    Http::FileServer fileServer(rootDirectory);
+    const auto resourceDelegate = fileServer.GetResourceDelegate();
+    const auto response = resourceDelegate(MakeRequest({ "hello.txt" }));
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(200, response->statusCode);
+    ASSERT_TRUE(response->headers.HasHeader("Content-Type"));
+    EXPECT_EQ("text/plain", response->headers.GetHeaderValue("Content-Type"));
+    EXPECT_EQ(rootDirectory + "/hello.txt", response->bodyFilePath);
+    EXPECT_EQ(0, response->bodyFileOffset);
+    EXPECT_EQ(15, response->bodyFileLength);
+}
+
+TEST(FileServerTests, MissingFileNotFound) {
+    const std::string rootDirectory = ::testing::TempDir();
+    Http::FileServer fileServer(rootDirectory);
+    const auto resourceDelegate = fileServer.GetResourceDelegate();
+    const auto response = resourceDelegate(MakeRequest({ "no-such-file.txt" }));
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(404, response->statusCode);
+    EXPECT_TRUE(response->bodyFilePath.empty());
+}
+
+TEST(FileServerTests, PathEscapingRootRejected) {
+    const std::string rootDirectory = ::testing::TempDir();
+    WriteFile(rootDirectory + "/secret.txt", "hunter2");
+    Http::FileServer fileServer(rootDirectory);
+    const auto resourceDelegate = fileServer.GetResourceDelegate();
+    for (const auto& path: std::vector< std::vector< std::string > >{
+        { "..", "secret.txt" },
+        { ".", "secret.txt" },
+        { "", "secret.txt" },
+        { },
+    }) {
+        const auto response = resourceDelegate(MakeRequest(path));
+        ASSERT_FALSE(response == nullptr);
+        EXPECT_EQ(404, response->statusCode);
+    }
+}
+
+TEST(FileServerTests, CachedSizeRevalidatedWhenFileChanges) {
+    const std::string rootDirectory = ::testing::TempDir();
+    const auto filePath = rootDirectory + "/changing.txt";
+    WriteFile(filePath, "Hello, World!\r\n");
+    Http::FileServer fileServer(rootDirectory);
+    const auto resourceDelegate = fileServer.GetResourceDelegate();
+    auto response = resourceDelegate(MakeRequest({ "changing.txt" }));
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(200, response->statusCode);
+    EXPECT_EQ(15, response->bodyFileLength);
+
+    // Truncate the file behind the server's back; a cached size must
+    // not leak into the next response's framing.
+    WriteFile(filePath, "Hi");
+    response = resourceDelegate(MakeRequest({ "changing.txt" }));
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(200, response->statusCode);
+    EXPECT_EQ(2, response->bodyFileLength);
+
+    // Delete the file; the stale cache entry must not produce a 200.
+    (void)std::remove(filePath.c_str());
+    response = resourceDelegate(MakeRequest({ "changing.txt" }));
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(404, response->statusCode);
+}
@@ -240,6 +240,30 @@ TEST_F(ServerTests, ServerTests_ParsePostRequest_Test) {
     ASSERT_EQ(rawRequest.length() - 2, messageEnd);
 }
 
+TEST_F(ServerTests, StandardMethodsInternedAsKnownMethodTokens) {
+    const std::vector< std::pair< std::string, Http::Server::Request::KnownMethod > > methods{
+        {"GET", Http::Server::Request::KnownMethod::Get},
+        {"HEAD", Http::Server::Request::KnownMethod::Head},
+        {"POST", Http::Server::Request::KnownMethod::Post},
+        {"PUT", Http::Server::Request::KnownMethod::Put},
+        {"DELETE", Http::Server::Request::KnownMethod::Delete},
+        {"OPTIONS", Http::Server::Request::KnownMethod::Options},
+        {"PATCH", Http::Server::Request::KnownMethod::Patch},
+        {"PROPFIND", Http::Server::Request::KnownMethod::Unknown},
+    };
+    for (const auto& method: methods) {
+        const auto request = server.ParseRequest(
+            method.first + " /hello.txt HTTP/1.1\r\n"
+            "Host: www.example.com\r\n"
+            "Content-Length: 0\r\n"
+            "\r\n"
+        );
+        ASSERT_FALSE(request == nullptr) << method.first;
+        EXPECT_EQ(method.first, request->method);
+        EXPECT_EQ(method.second, request->knownMethod) << method.first;
+    }
+}
+
 TEST_F(ServerTests, ServerTests_ParseInvalidRequestNoMethod_Test) {
     size_t messageEnd;
     const std::string rawRequest = (        
@@ -997,6 +1021,80 @@ TEST_F(ServerTests, ClientSentRequestWithTooLargePayload) {
     EXPECT_TRUE(connection->broken);
 }
 
+TEST_F(ServerTests, ClientDribblingHeadersOverConnectionBufferLimit) {
+    auto transport = std::make_shared< MockTransport >();
+    const Http::Server::MobilizationDependencies dep = {transport, 1234};
+    server.SetConfigurationItem("ConnectionBufferLimit", "100");
+    (void)server.Mobilize(dep);
+    auto connection = std::make_shared< MockConnection >();
+    transport->connectionDelegate(connection);
+    // Dribble header lines without ever finishing the header section,
+    // until the connection's buffer budget is exceeded.
+    const std::string requestPiece(
+        "GET /hello.txt HTTP/1.1\r\n"
+        "X-Padding: aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa\r\n"
+    );
+    for (size_t i = 0; (i < 10) && !connection->broken; ++i) {
+        connection->dataReceivedDelegate(
+            std::vector< uint8_t >(
+                requestPiece.begin(),
+                requestPiece.end()
+            )
+        );
+    }
+    Http::Client client;
+    const auto response = client.ParseResponse(
+        std::string(
+            connection->dataReceived.begin(),
+            connection->dataReceived.end()
+        )
+    );
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(431, response->statusCode);
+    EXPECT_EQ("Request Header Fields Too Large", response->status);
+    EXPECT_TRUE(connection->broken);
+}
+
+TEST_F(ServerTests, MobilizeWithExtraBindingsListensOnAllOfThem) {
+    auto transport = std::make_shared< MockTransport >();
+    auto extraTransport = std::make_shared< MockTransport >();
+    Http::Server::MobilizationDependencies dep = {transport, 1234};
+    dep.extraBindings.push_back({extraTransport, 1235});
+    ASSERT_TRUE(server.Mobilize(dep));
+    ASSERT_TRUE(transport->bound);
+    ASSERT_TRUE(extraTransport->bound);
+    ASSERT_EQ(1234, transport->port);
+    ASSERT_EQ(1235, extraTransport->port);
+    // A connection accepted through the extra listener should be
+    // served just like one accepted through the primary listener.
+    auto connection = std::make_shared< MockConnection >();
+    extraTransport->connectionDelegate(connection);
+    ASSERT_FALSE(connection->dataReceivedDelegate == nullptr);
+    const std::string request(
+        "GET /hello.txt HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "\r\n"
+    );
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            request.begin(),
+            request.end()
+        )
+    );
+    Http::Client client;
+    const auto response = client.ParseResponse(
+        std::string(
+            connection->dataReceived.begin(),
+            connection->dataReceived.end()
+        )
+    );
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(404, response->statusCode);
+    server.Demobilize();
+    ASSERT_FALSE(transport->bound);
+    ASSERT_FALSE(extraTransport->bound);
+}
+
 TEST_F(ServerTests, ServerTests_DefaultServerUri_Test) {
     ASSERT_EQ("", server.GetConfigurationItem("Host"));
     const std::vector< std::string > testVectors{
@@ -1113,6 +1211,308 @@ TEST_F(ServerTests, ServerTests_RegisterResourceSubspaceDelegate__Test) {
     connection->dataReceived.clear();
 }
 
+TEST_F(ServerTests, StreamingHandlerReceivesBodyInPieces) {
+    auto transport = std::make_shared< MockTransport >();
+    const Http::Server::MobilizationDependencies dep = {transport, 1234};
+    (void)server.Mobilize(dep);
+    auto connection = std::make_shared < MockConnection >();
+    transport->connectionDelegate(connection);
+    std::vector< std::string > bodyPieces;
+    const auto streamingResourceDelegate = [&bodyPieces](
+        std::shared_ptr< Http::Server::Request > request
+    ) -> Http::IServer::RequestBodyDelegate {
+        return [&bodyPieces](
+            const std::string& bodyData,
+            bool lastPiece
+        ) -> std::shared_ptr< Http::Client::Response > {
+            bodyPieces.push_back(bodyData);
+            if (!lastPiece) {
+                return nullptr;
+            }
+            const auto response = std::make_shared< Http::Client::Response >();
+            response->statusCode = 200;
+            response->status = "OK";
+            return response;
+        };
+    };
+    const auto unregistrationDelegate = server.RegisterStreamingResource(
+        { "upload" },
+        streamingResourceDelegate
+    );
+    const std::string requestHead = (
+        "POST /upload HTTP/1.1\r\n"
+        "Host: www.exemple.com\r\n"
+        "Content-Length: 10\r\n"
+        "\r\n"
+    );
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            requestHead.begin(),
+            requestHead.end()
+        )
+    );
+    const std::string firstBodyPiece = "Hello";
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            firstBodyPiece.begin(),
+            firstBodyPiece.end()
+        )
+    );
+    EXPECT_EQ(
+        (std::vector< std::string >{ "Hello" }),
+        bodyPieces
+    );
+    EXPECT_TRUE(connection->dataReceived.empty());
+    const std::string secondBodyPiece = "World";
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            secondBodyPiece.begin(),
+            secondBodyPiece.end()
+        )
+    );
+    EXPECT_EQ(
+        (std::vector< std::string >{ "Hello", "World", "" }),
+        bodyPieces
+    );
+    Http::Client client;
+    const auto response = client.ParseResponse(
+        std::string(
+            connection->dataReceived.begin(),
+            connection->dataReceived.end()
+        )
+    );
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(200, response->statusCode);
+    unregistrationDelegate();
+}
+
+TEST_F(ServerTests, StreamingHandlerDecliningGetsBufferedBody) {
+    auto transport = std::make_shared< MockTransport >();
+    const Http::Server::MobilizationDependencies dep = {transport, 1234};
+    (void)server.Mobilize(dep);
+    auto connection = std::make_shared < MockConnection >();
+    transport->connectionDelegate(connection);
+    std::vector< std::vector< std::string > > targetPathsSeen;
+    std::vector< std::string > bodiesDelivered;
+    const auto streamingResourceDelegate = [&targetPathsSeen, &bodiesDelivered](
+        std::shared_ptr< Http::Server::Request > request
+    ) -> Http::IServer::RequestBodyDelegate {
+        targetPathsSeen.push_back(request->target.GetPath());
+        if (request->state != Http::Server::Request::RequestParsingState::Complete) {
+            // Decline streaming while only the headers have been
+            // received; the body should come back buffered.
+            return nullptr;
+        }
+        return [&bodiesDelivered](
+            const std::string& bodyData,
+            bool lastPiece
+        ) -> std::shared_ptr< Http::Client::Response > {
+            bodiesDelivered.push_back(bodyData);
+            const auto response = std::make_shared< Http::Client::Response >();
+            response->statusCode = 200;
+            response->status = "OK";
+            return response;
+        };
+    };
+    const auto unregistrationDelegate = server.RegisterStreamingResource(
+        { "stream" },
+        streamingResourceDelegate
+    );
+    const std::string request = (
+        "POST /stream/foo HTTP/1.1\r\n"
+        "Host: www.exemple.com\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "Hello"
+    );
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            request.begin(),
+            request.end()
+        )
+    );
+    Http::Client client;
+    const auto response = client.ParseResponse(
+        std::string(
+            connection->dataReceived.begin(),
+            connection->dataReceived.end()
+        )
+    );
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(200, response->statusCode);
+    ASSERT_EQ(2, targetPathsSeen.size());
+    EXPECT_EQ(
+        (std::vector< std::string >{ "foo" }),
+        targetPathsSeen[0]
+    );
+    EXPECT_EQ(
+        (std::vector< std::string >{ "foo" }),
+        targetPathsSeen[1]
+    );
+    ASSERT_EQ(
+        (std::vector< std::string >{ "Hello" }),
+        bodiesDelivered
+    );
+    unregistrationDelegate();
+}
+
+TEST_F(ServerTests, ExpectContinueAnsweredBeforeBodyIsSent) {
+    auto transport = std::make_shared< MockTransport >();
+    const Http::Server::MobilizationDependencies dep = {transport, 1234};
+    (void)server.Mobilize(dep);
+    std::vector< std::string > requestBodies;
+    const auto resourceDelegate = [&requestBodies](
+        std::shared_ptr< Http::Server::Request > request
+    ){
+        const auto response = std::make_shared< Http::Client::Response >();
+        response->statusCode = 200;
+        response->status = "OK";
+        requestBodies.push_back(request->body);
+        return response;
+    };
+    const auto unregistrationDelegate = server.RegisterResource({ "upload" }, resourceDelegate);
+
+    // A client expecting "100-continue" on a routable request should
+    // get the interim response before sending any of the body.
+    auto connection = std::make_shared < MockConnection >();
+    transport->connectionDelegate(connection);
+    const std::string requestHead = (
+        "POST /upload HTTP/1.1\r\n"
+        "Host: www.exemple.com\r\n"
+        "Content-Length: 5\r\n"
+        "Expect: 100-continue\r\n"
+        "\r\n"
+    );
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            requestHead.begin(),
+            requestHead.end()
+        )
+    );
+    EXPECT_EQ(
+        "HTTP/1.1 100 Continue\r\n\r\n",
+        std::string(
+            connection->dataReceived.begin(),
+            connection->dataReceived.end()
+        )
+    );
+    EXPECT_TRUE(requestBodies.empty());
+    connection->dataReceived.clear();
+    const std::string requestBody = "Hello";
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            requestBody.begin(),
+            requestBody.end()
+        )
+    );
+    Http::Client client;
+    const auto response = client.ParseResponse(
+        std::string(
+            connection->dataReceived.begin(),
+            connection->dataReceived.end()
+        )
+    );
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(200, response->statusCode);
+    ASSERT_EQ(
+        (std::vector< std::string >{ "Hello" }),
+        requestBodies
+    );
+
+    // A client expecting "100-continue" on a request no handler
+    // covers should get the final error right away instead.
+    auto rejectedConnection = std::make_shared < MockConnection >();
+    transport->connectionDelegate(rejectedConnection);
+    const std::string unroutableRequestHead = (
+        "POST /nowhere HTTP/1.1\r\n"
+        "Host: www.exemple.com\r\n"
+        "Content-Length: 5\r\n"
+        "Expect: 100-continue\r\n"
+        "\r\n"
+    );
+    rejectedConnection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            unroutableRequestHead.begin(),
+            unroutableRequestHead.end()
+        )
+    );
+    const auto rejection = client.ParseResponse(
+        std::string(
+            rejectedConnection->dataReceived.begin(),
+            rejectedConnection->dataReceived.end()
+        )
+    );
+    ASSERT_FALSE(rejection == nullptr);
+    EXPECT_EQ(404, rejection->statusCode);
+    EXPECT_TRUE(rejectedConnection->broken);
+    unregistrationDelegate();
+}
+
+TEST_F(ServerTests, AsyncResourceDelegateKeepsPipelinedResponsesInOrder) {
+    auto transport = std::make_shared< MockTransport >();
+    const Http::Server::MobilizationDependencies dep = {transport, 1234};
+    (void)server.Mobilize(dep);
+    auto connection = std::make_shared < MockConnection >();
+    transport->connectionDelegate(connection);
+
+    Http::IServer::ResponseCompleteDelegate completeSlowResponse;
+    const auto asyncResourceDelegate = [&completeSlowResponse](
+        std::shared_ptr< Http::Server::Request > request,
+        Http::IServer::ResponseCompleteDelegate responseComplete
+    ){
+        completeSlowResponse = responseComplete;
+    };
+    const auto unregisterSlow = server.RegisterAsyncResource({ "slow" }, asyncResourceDelegate);
+    const auto resourceDelegate = [](
+        std::shared_ptr< Http::Server::Request > request
+    ){
+        const auto response = std::make_shared< Http::Client::Response >();
+        response->statusCode = 200;
+        response->status = "OK";
+        response->body = "fast";
+        return response;
+    };
+    const auto unregisterFast = server.RegisterResource({ "fast" }, resourceDelegate);
+    const std::string requests = (
+        "GET /slow HTTP/1.1\r\n"
+        "Host: www.exemple.com\r\n"
+        "\r\n"
+        "GET /fast HTTP/1.1\r\n"
+        "Host: www.exemple.com\r\n"
+        "\r\n"
+    );
+    connection->dataReceivedDelegate(
+        std::vector< uint8_t >(
+            requests.begin(),
+            requests.end()
+        )
+    );
+    ASSERT_FALSE(completeSlowResponse == nullptr);
+    EXPECT_TRUE(connection->dataReceived.empty());
+    const auto slowResponse = std::make_shared< Http::Client::Response >();
+    slowResponse->statusCode = 200;
+    slowResponse->status = "OK";
+    slowResponse->body = "slow";
+    completeSlowResponse(slowResponse);
+    const std::string responses(
+        connection->dataReceived.begin(),
+        connection->dataReceived.end()
+    );
+    Http::Client client;
+    size_t messageEnd;
+    auto response = client.ParseResponse(responses, messageEnd);
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(200, response->statusCode);
+    EXPECT_EQ("slow", response->body);
+    response = client.ParseResponse(responses.substr(messageEnd));
+    ASSERT_FALSE(response == nullptr);
+    EXPECT_EQ(200, response->statusCode);
+    EXPECT_EQ("fast", response->body);
+    connection->dataReceived.clear();
+    unregisterSlow();
+    unregisterFast();
+}
+
 TEST_F(ServerTests, ServerTests_RegisterResourceWideServerDelegate__Test) {
     auto transport = std::make_shared< MockTransport >();
     const Http::Server::MobilizationDependencies dep = {transport, 1234};